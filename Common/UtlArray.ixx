@@ -1,3 +1,7 @@
+module;
+
+#include <assert.h>
+
 export module UtlArray;
 
 import std;
@@ -107,3 +111,125 @@ auto UTIL_ArraySetDiff(std::span<T const> lhs, std::span<T const> rhs) noexcept
 
 	return r;
 }
+
+// Fixed capacity double-ended queue over a contiguous array.
+// Never allocates, hence copying it around is a plain memcpy-ish operation and clear() keeps the storage warm.
+export template <typename T, std::size_t N>
+struct CRingBuffer final
+{
+	static_assert(std::has_single_bit(N), "Capacity must be a power of two.");
+
+	template <bool bConst>
+	struct iterator_t final
+	{
+		using iterator_concept = std::random_access_iterator_tag;
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<bConst, T const*, T*>;
+		using reference = std::conditional_t<bConst, T const&, T&>;
+		using container_type = std::conditional_t<bConst, CRingBuffer const, CRingBuffer>;
+
+		container_type* m_pRing{};
+		difference_type m_iIndex{};	// logical index, 0 is front()
+
+		constexpr reference operator*() const noexcept { return (*m_pRing)[(std::size_t)m_iIndex]; }
+		constexpr pointer operator->() const noexcept { return std::addressof(**this); }
+		constexpr reference operator[](difference_type i) const noexcept { return (*m_pRing)[(std::size_t)(m_iIndex + i)]; }
+
+		constexpr iterator_t& operator++() noexcept { ++m_iIndex; return *this; }
+		constexpr iterator_t& operator--() noexcept { --m_iIndex; return *this; }
+		constexpr iterator_t operator++(int) noexcept { auto ret = *this; ++m_iIndex; return ret; }
+		constexpr iterator_t operator--(int) noexcept { auto ret = *this; --m_iIndex; return ret; }
+		constexpr iterator_t& operator+=(difference_type i) noexcept { m_iIndex += i; return *this; }
+		constexpr iterator_t& operator-=(difference_type i) noexcept { m_iIndex -= i; return *this; }
+
+		friend constexpr iterator_t operator+(iterator_t it, difference_type i) noexcept { return it += i; }
+		friend constexpr iterator_t operator+(difference_type i, iterator_t it) noexcept { return it += i; }
+		friend constexpr iterator_t operator-(iterator_t it, difference_type i) noexcept { return it -= i; }
+		friend constexpr difference_type operator-(iterator_t const& lhs, iterator_t const& rhs) noexcept { return lhs.m_iIndex - rhs.m_iIndex; }
+
+		friend constexpr bool operator==(iterator_t const& lhs, iterator_t const& rhs) noexcept { return lhs.m_iIndex == rhs.m_iIndex; }
+		friend constexpr auto operator<=>(iterator_t const& lhs, iterator_t const& rhs) noexcept { return lhs.m_iIndex <=> rhs.m_iIndex; }
+
+		constexpr operator iterator_t<true>() const noexcept requires (!bConst) { return { m_pRing, m_iIndex }; }
+	};
+
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = T&;
+	using const_reference = T const&;
+	using iterator = iterator_t<false>;
+	using const_iterator = iterator_t<true>;
+
+	static constexpr std::size_t capacity() noexcept { return N; }
+	constexpr std::size_t size() const noexcept { return m_iSize; }
+	constexpr bool empty() const noexcept { return m_iSize == 0; }
+	constexpr bool full() const noexcept { return m_iSize == N; }
+
+	constexpr T& operator[](std::size_t i) noexcept { assert(i < m_iSize); return m_rgData[(m_iHead + i) & (N - 1)]; }
+	constexpr T const& operator[](std::size_t i) const noexcept { assert(i < m_iSize); return m_rgData[(m_iHead + i) & (N - 1)]; }
+
+	constexpr T& front() noexcept { return (*this)[0]; }
+	constexpr T const& front() const noexcept { return (*this)[0]; }
+	constexpr T& back() noexcept { return (*this)[m_iSize - 1]; }
+	constexpr T const& back() const noexcept { return (*this)[m_iSize - 1]; }
+
+	constexpr iterator begin() noexcept { return { this, 0 }; }
+	constexpr iterator end() noexcept { return { this, (difference_type)m_iSize }; }
+	constexpr const_iterator begin() const noexcept { return { this, 0 }; }
+	constexpr const_iterator end() const noexcept { return { this, (difference_type)m_iSize }; }
+	constexpr const_iterator cbegin() const noexcept { return begin(); }
+	constexpr const_iterator cend() const noexcept { return end(); }
+
+	// Returns nullptr when full, the content is left untouched.
+	template <typename... Tys>
+	constexpr T* emplace_front(Tys&&... args) noexcept
+	{
+		if (full())
+			return nullptr;
+
+		m_iHead = (m_iHead - 1) & (N - 1);
+		++m_iSize;
+
+		return std::addressof(m_rgData[m_iHead] = T{ std::forward<Tys>(args)... });
+	}
+
+	// Returns nullptr when full, the content is left untouched.
+	template <typename... Tys>
+	constexpr T* emplace_back(Tys&&... args) noexcept
+	{
+		if (full())
+			return nullptr;
+
+		auto& ret = m_rgData[(m_iHead + m_iSize) & (N - 1)] = T{ std::forward<Tys>(args)... };
+		++m_iSize;
+
+		return std::addressof(ret);
+	}
+
+	constexpr void pop_front(std::size_t iCount = 1) noexcept
+	{
+		iCount = std::min(iCount, m_iSize);
+
+		m_iHead = (m_iHead + iCount) & (N - 1);
+		m_iSize -= iCount;
+	}
+
+	constexpr void pop_back(std::size_t iCount = 1) noexcept
+	{
+		m_iSize -= std::min(iCount, m_iSize);
+	}
+
+	constexpr void clear() noexcept
+	{
+		m_iHead = 0;
+		m_iSize = 0;
+	}
+
+private:
+	std::array<T, N> m_rgData{};
+	std::size_t m_iHead{};
+	std::size_t m_iSize{};
+};
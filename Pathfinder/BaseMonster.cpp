@@ -19,41 +19,19 @@ import hlsdk;
 
 import BaseMonster;
 import CBase;
+import DebugDraw;
 import Math;
 import Task;
 import FileSystem;
 
+import Improvisational;
 import LocalNav;
+import Nav;
 
 import UtlRandom;
 
 
 
-inline void UTIL_DrawBeamPoints(Vector const& vecStart, Vector const& vecEnd,
-	int iLifetime, std::uint8_t bRed, std::uint8_t bGreen, std::uint8_t bBlue) noexcept
-{
-	g_engfuncs.pfnMessageBegin(MSG_PVS, SVC_TEMPENTITY, vecStart, nullptr);
-	g_engfuncs.pfnWriteByte(TE_BEAMPOINTS);
-	g_engfuncs.pfnWriteCoord(vecStart.x);
-	g_engfuncs.pfnWriteCoord(vecStart.y);
-	g_engfuncs.pfnWriteCoord(vecStart.z);
-	g_engfuncs.pfnWriteCoord(vecEnd.x);
-	g_engfuncs.pfnWriteCoord(vecEnd.y);
-	g_engfuncs.pfnWriteCoord(vecEnd.z);
-	g_engfuncs.pfnWriteShort(g_engfuncs.pfnModelIndex("sprites/smoke.spr"));
-	g_engfuncs.pfnWriteByte(0);	// starting frame
-	g_engfuncs.pfnWriteByte(0);	// frame rate
-	g_engfuncs.pfnWriteByte(iLifetime);
-	g_engfuncs.pfnWriteByte(10);	// width
-	g_engfuncs.pfnWriteByte(0);	// noise
-	g_engfuncs.pfnWriteByte(bRed);
-	g_engfuncs.pfnWriteByte(bGreen);
-	g_engfuncs.pfnWriteByte(bBlue);
-	g_engfuncs.pfnWriteByte(255);	// brightness
-	g_engfuncs.pfnWriteByte(0);	// scroll speed
-	g_engfuncs.pfnMessageEnd();
-}
-
 // Single action
 
 Task CBaseAI::Task_Move_Turn(bool const bSkipAnim) noexcept
@@ -190,7 +168,7 @@ Task CBaseAI::Task_Move_Detour(Vector vecTarget, double flApprox) noexcept
 {
 	static constexpr auto RUN_DIST_SQ = 270.0 * 270.0;
 
-	CStuckMonitor StuckMonitor{};
+	CStuckMonitor StuckMonitor{ STUCK_PROFILE_MONSTER };
 	std::vector<Vector> Nodes{};
 
 	goto LAB_DETOUR_START;
@@ -275,25 +253,59 @@ Task CBaseAI::Task_Move_Ladder(CNavLadder const* ladder, NavTraverseType how, CN
 
 	if (how == GO_LADDER_DOWN)
 	{
-		m_vecGoal = ladder->m_top + Vector{ ladder->m_dirVector, 0 } * 16;
-
 		// When moving down, the starting post is extra-important.
-		do
+		// The spot the geometry leaves for a hull of our size only has to be confirmed against other monsters,
+		// every step before it is blocked by the world whether monsters are ignored or not.
+		auto const iProbes = ladder->FindMountTop(pev->mins, pev->maxs, [&](Vector const& vecSpot, TraceResult* ptr) noexcept
 		{
 			g_engfuncs.pfnTraceMonsterHull(
 				edict(),
-				m_vecGoal,
-				Vector{ m_vecGoal.x, m_vecGoal.y, m_vecGoal.z - 80.f },
-				dont_ignore_monsters | dont_ignore_glass,
+				vecSpot,
+				Vector{ vecSpot.x, vecSpot.y, vecSpot.z - 80.f },
+				ignore_monsters | dont_ignore_glass,
 				edict(),
-				&tr
+				ptr
 			);
+		});
+
+		auto const vecClear = ladder->MountTopStart() + Vector{ ladder->m_dirVector, 0 } * (float)(iProbes - 1);
+
+		g_engfuncs.pfnTraceMonsterHull(
+			edict(),
+			vecClear,
+			Vector{ vecClear.x, vecClear.y, vecClear.z - 80.f },
+			dont_ignore_monsters | dont_ignore_glass,
+			edict(),
+			&tr
+		);
 
-			// One unit.
-			m_vecGoal.x += ladder->m_dirVector.x;
-			m_vecGoal.y += ladder->m_dirVector.y;
+		if (!tr.fAllSolid && !tr.fStartSolid && tr.flFraction >= 1.f)
+		{
+			// Same spot the search below ends on, one unit past the clear one.
+			m_vecGoal = vecClear + Vector{ ladder->m_dirVector, 0 };
+			CNavLadder::m_iTracesAvoided += iProbes - 1;
+		}
+		else
+		{
+			m_vecGoal = ladder->MountTopStart();
 
-		} while (tr.fAllSolid || tr.fStartSolid || tr.flFraction < 1.f);
+			do
+			{
+				g_engfuncs.pfnTraceMonsterHull(
+					edict(),
+					m_vecGoal,
+					Vector{ m_vecGoal.x, m_vecGoal.y, m_vecGoal.z - 80.f },
+					dont_ignore_monsters | dont_ignore_glass,
+					edict(),
+					&tr
+				);
+
+				// One unit.
+				m_vecGoal.x += ladder->m_dirVector.x;
+				m_vecGoal.y += ladder->m_dirVector.y;
+
+			} while (tr.fAllSolid || tr.fStartSolid || tr.flFraction < 1.f);
+		}
 
 		auto const vecLadderTop{ m_vecGoal };
 //		Detour(m_vecGoal, 1);	// We have NO torlerance when ladders involved.
@@ -316,7 +328,7 @@ Task CBaseAI::Task_Move_Ladder(CNavLadder const* ladder, NavTraverseType how, CN
 		}
 
 		pev->velocity = g_vecZero;	// Stop immediately, preventing the sliding effect in flying mode.
-		Turn((-ladder->m_dirVector).Yaw(), true);
+		Turn(ladder->m_flClimbYaw, true);
 
 		// Start climbing
 		InsertingAnim(ACT_HOVER);
@@ -339,14 +351,14 @@ Task CBaseAI::Task_Move_Ladder(CNavLadder const* ladder, NavTraverseType how, CN
 	}
 	else if (how == GO_LADDER_UP)
 	{
-		m_vecGoal = ladder->m_bottom + Vector{ ladder->m_dirVector, 0 } * 17;
+		m_vecGoal = ladder->m_vecMountBottom;
 
 		// Go and find the bottom of the ladder
 		Detour(m_vecGoal, 4);
 		while (m_Scheduler.Exist(TASK_MOVE_DETOUR))
 			co_await TaskScheduler::NextFrame::Rank[4];
 
-		Turn((-ladder->m_dirVector).Yaw(), true);
+		Turn(ladder->m_flClimbYaw, true);
 
 		// Start climbing
 		InsertingAnim(ACT_HOVER);
@@ -394,7 +406,7 @@ Task CBaseAI::Task_Move_Ladder(CNavLadder const* ladder, NavTraverseType how, CN
 
 Task CBaseAI::Task_Plot_WalkOnPath(Vector const vecTarget, double flApprox) noexcept
 {
-	CStuckMonitor StuckMonitor{};
+	CStuckMonitor StuckMonitor{ STUCK_PROFILE_MONSTER };
 
 	for (;;)
 	{
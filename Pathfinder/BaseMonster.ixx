@@ -12,6 +12,7 @@ export module BaseMonster;
 import std;
 import hlsdk;
 
+import DebugDraw;
 import Prefab;
 import Task;
 import Models;
@@ -19,50 +20,36 @@ import Models;
 import Improvisational;
 import LocalNav;
 
+import UtlArray;
 import UtlRandom;
 import UtlString;
 
 
 
-extern "C++" inline void UTIL_DrawBeamPoints(Vector const& vecStart, Vector const& vecEnd,
-	int iLifetime, std::uint8_t bRed, std::uint8_t bGreen, std::uint8_t bBlue) noexcept
-{
-	g_engfuncs.pfnMessageBegin(MSG_PVS, SVC_TEMPENTITY, vecStart, nullptr);
-	g_engfuncs.pfnWriteByte(TE_BEAMPOINTS);
-	g_engfuncs.pfnWriteCoord(vecStart.x);
-	g_engfuncs.pfnWriteCoord(vecStart.y);
-	g_engfuncs.pfnWriteCoord(vecStart.z);
-	g_engfuncs.pfnWriteCoord(vecEnd.x);
-	g_engfuncs.pfnWriteCoord(vecEnd.y);
-	g_engfuncs.pfnWriteCoord(vecEnd.z);
-	g_engfuncs.pfnWriteShort(g_engfuncs.pfnModelIndex("sprites/smoke.spr"));
-	g_engfuncs.pfnWriteByte(0);	// starting frame
-	g_engfuncs.pfnWriteByte(0);	// frame rate
-	g_engfuncs.pfnWriteByte(iLifetime);
-	g_engfuncs.pfnWriteByte(10);	// width
-	g_engfuncs.pfnWriteByte(0);	// noise
-	g_engfuncs.pfnWriteByte(bRed);
-	g_engfuncs.pfnWriteByte(bGreen);
-	g_engfuncs.pfnWriteByte(bBlue);
-	g_engfuncs.pfnWriteByte(255);	// brightness
-	g_engfuncs.pfnWriteByte(0);	// scroll speed
-	g_engfuncs.pfnMessageEnd();
-}
+// Same limit as CNavPath::m_path
+export using PathSegmentRing = CRingBuffer<PathSegment, 256>;
 
 export struct Navigator
 {
 	EHANDLE<CBaseEntity> m_pHost{};
 	EHANDLE<CBaseEntity> m_pTargetEnt{};
-	std::vector<localnode_t> m_nodeArr{ (size_t)0x80, localnode_t{} };
 	node_index_t m_nindexAvailableNode{};
 	Vector m_vecStartingLoc{};
-	std::deque<PathSegment> m_Segments{};
+	PathSegmentRing m_Segments{};
 	std::move_only_function<float(CNavArea*, CNavArea*, const CNavLadder*) noexcept> m_CostFunc{ HostagePathCost{} };
 	mutable bool m_fTargetEntHit{ false };
 
 	static inline int& m_NodeValue{ CLocalNav::m_NodeValue };
 	static inline float& m_flLastThinkTime{ CLocalNav::m_flLastThinkTime };
 
+	// Nodes a single FindLocalPath() may spend before giving up.
+	static inline constexpr node_index_t MAX_LOCAL_NODES = 0x80;
+
+	// Scratch space of FindLocalPath(). Compute() never suspends, so one pool serves every navigator.
+	// It only grows, therefore repathing stops allocating once the largest search had been seen.
+	// Its size is a high-water mark of every navigator, never a budget: that is MAX_LOCAL_NODES.
+	static inline std::vector<localnode_t> m_nodeArr{ (size_t)MAX_LOCAL_NODES, localnode_t{} };
+
 	inline bool IsValid() const noexcept { return !m_Segments.empty(); }
 	inline void Invalidate() noexcept { m_Segments.clear(); }
 
@@ -95,12 +82,16 @@ export struct Navigator
 		{
 			// This linked list is tracking our path backwards.
 			// Hence emplace_front.
-			m_Segments.emplace_front(
+			[[unlikely]]
+			if (!m_Segments.emplace_front(
 				pArea,
 				pArea->GetParentHow(),
 				pArea->GetCenter(),
 				nullptr
-			);
+			))
+			{
+				return PathTooLong();
+			}
 		}
 
 		if (m_Segments.size() == 1)
@@ -122,10 +113,7 @@ export struct Navigator
 						|| ladder->m_topRightArea == to.area)
 					{
 						to.ladder = ladder;
-						to.pos = ladder->m_bottom;
-
-						// Ensure this point was not stuck in the wall or ladder entity.
-						AddDirectionVector(&to.pos, ladder->m_dir, 2.0f * HalfHumanWidth);
+						to.pos = ladder->m_vecUpApproach;	// Ensure this point was not stuck in the wall or ladder entity.
 						break;
 					}
 				}
@@ -150,11 +138,10 @@ export struct Navigator
 					if (ladder->m_bottomArea == to.area)
 					{
 						to.ladder = ladder;
-						to.pos = ladder->m_top;
 
 						// LUNA: originally it's Opposite[ladder->m_dir] here.
 						// I don't get it, this calc will cause the pos ends up in the ladder or wall.
-						AddDirectionVector(&to.pos, ladder->m_dir, 2.0f * HalfHumanWidth);
+						to.pos = ladder->m_vecDownApproach;
 						break;
 					}
 				}
@@ -172,12 +159,16 @@ export struct Navigator
 		}
 
 		// append path end position
-		m_Segments.emplace_back(
+		[[unlikely]]
+		if (!m_Segments.emplace_back(
 			effectiveGoalArea,
 			GO_DIRECTLY,
 			Vector{ vecGoal.x, vecGoal.y, pGoalArea->GetZ(vecGoal) },
 			nullptr
-		);
+		))
+		{
+			return PathTooLong();
+		}
 
 		m_Segments.front().how = GO_DIRECTLY;
 
@@ -197,14 +188,17 @@ export struct Navigator
 			auto const pArea = TheNavAreaGrid.GetNearestNavArea(CurNode.vecLoc);
 
 			// Same as CZBOT nav, it's tracking from end to start.
-			m_Segments.emplace_front(
+			[[unlikely]]
+			if (!m_Segments.emplace_front(
 				pArea,
 				GO_DIRECTLY,
 				Vector{ CurNode.vecLoc.x, CurNode.vecLoc.y, pArea->GetZ(CurNode.vecLoc) },
 				nullptr
-			);
+			))
+			{
+				return PathTooLong();
+			}
 
-			auto& ref = m_Segments.front().pos;
 			nCurrentIndex = CurNode.nindexParent;	// this is where the 'next' in cur for loop is - fuck the C++ scope.
 		}
 
@@ -213,6 +207,16 @@ export struct Navigator
 		return true;
 	}
 
+	bool PathTooLong() noexcept
+	{
+		g_engfuncs.pfnServerPrint(
+			std::format("Path exceeds {} segments, dropped.\n", PathSegmentRing::capacity()).c_str()
+		);
+
+		Invalidate();
+		return false;
+	}
+
 	// Build trivial path when start and goal are in the same nav area
 	bool BuildTrivialPath(Vector const& vecSrc, Vector const& vecGoal) noexcept
 	{
@@ -272,8 +276,8 @@ export struct Navigator
 			if (flDistToDest <= HOSTAGE_STEPSIZE)
 				break;
 
-			if (((flDistToDest - flTargetRadius) > ((m_nodeArr.size() - m_nindexAvailableNode) * HOSTAGE_STEPSIZE))
-				|| m_nindexAvailableNode == m_nodeArr.size())
+			if (((flDistToDest - flTargetRadius) > ((MAX_LOCAL_NODES - m_nindexAvailableNode) * HOSTAGE_STEPSIZE))
+				|| m_nindexAvailableNode >= MAX_LOCAL_NODES)
 			{
 				nIndexBest = NODE_INVALID_EMPTY;
 				break;
@@ -614,7 +618,7 @@ export struct Navigator
 			{
 				// nCount - the global index actually, not only for the subrange.
 				// So now we are erasing from the first to the N-th.
-				Path.erase(Path.begin(), Path.begin() + nCount);
+				Path.pop_front(nCount);
 				return true;
 			}
 
@@ -1648,7 +1652,7 @@ export struct CBaseAI : Prefab_t
 
 		for (;;)
 		{
-			co_await 0.01f;	// avoid inf loop.
+			co_await 0.1f;	// avoid inf loop.
 
 			if (segments.size() >= 1)
 			{
@@ -1706,8 +1710,6 @@ export struct CBaseAI : Prefab_t
 					);
 					break;
 				}
-
-				co_await 0.01f;
 			}
 
 			UTIL_DrawBeamPoints(
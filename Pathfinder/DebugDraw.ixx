@@ -0,0 +1,351 @@
+export module DebugDraw;
+
+import std;
+import hlsdk;
+
+import CBase;
+
+
+
+export namespace DebugDraw
+{
+	// Wire cost of one TE_BEAMPOINTS: svc byte, TE id, 6 coords, sprite short and 10 parameter bytes.
+	inline constexpr std::size_t BEAMPOINTS_MSG_SIZE = 1 + 1 + 6 * 2 + 2 + 10;
+
+	// Distinct lines kept alive at once. Beyond this new ones are dropped until old ones die.
+	inline constexpr std::size_t MAX_LINES = 4096;
+
+	// Temp entity bytes each client may receive from debug lines in a single frame.
+	inline constexpr std::size_t BYTES_PER_CLIENT_FRAME = 512;
+
+	// Endpoints closer than this are welded together for dedup and merging.
+	inline constexpr float WELD_DIST = 1.f;
+
+	// cos() of the largest angle two segments may bend by and still merge into one.
+	inline constexpr float COLLINEAR_COS = 0.9995f;
+
+	// The longest life a beam can carry in its byte field, in seconds.
+	inline constexpr float MAX_BEAM_LIFE = 25.5f;
+
+	struct stats_t
+	{
+		std::size_t m_iEnqueued{};
+		std::size_t m_iDeduped{};
+		std::size_t m_iMerged{};
+		std::size_t m_iMsgSent{};
+		std::size_t m_iBytesSent{};
+		std::size_t m_iDeferred{};	// resend postponed because the client ran out of budget
+		std::size_t m_iCulled{};	// skipped for a client whose PVS does not hold the line
+		std::size_t m_iDropped{};	// queue full, or nobody around to see it
+	};
+
+	inline stats_t m_Stats{};
+}
+
+using point_key_t = std::tuple<int, int, int, std::uint32_t>;
+using segment_key_t = std::tuple<int, int, int, int, int, int, std::uint32_t>;
+
+struct line_t
+{
+	Vector m_vecStart{};
+	Vector m_vecEnd{};
+	std::uint32_t m_iColor{};	// 0x00RRGGBB
+	float m_flDieTime{};
+	std::array<float, 32> m_rgflVisibleUntil{};	// when the beam on each client fades
+	std::uint32_t m_bitsPVS{};	// client slots whose PVS holds m_vecStart, as of m_flPVSTime
+	float m_flPVSTime{ -1.f };
+	std::vector<segment_key_t> m_rgAliases{};	// every enqueued segment which folded into this line
+};
+
+inline std::vector<line_t> m_Lines{};
+inline std::map<segment_key_t, std::size_t> m_Aliases{};
+inline std::multimap<point_key_t, std::size_t> m_Endpoints{};
+inline std::array<std::size_t, 32> m_rgiCursor{};	// round-robin start per client, so no line starves.
+inline short m_iBeamSprite{};
+
+inline point_key_t MakeKey(Vector const& vec, std::uint32_t iColor) noexcept
+{
+	return {
+		(int)std::lround(vec.x / DebugDraw::WELD_DIST),
+		(int)std::lround(vec.y / DebugDraw::WELD_DIST),
+		(int)std::lround(vec.z / DebugDraw::WELD_DIST),
+		iColor,
+	};
+}
+
+// Direction independent: A->B and B->A are the same line on screen.
+inline segment_key_t MakeKey(Vector const& vecStart, Vector const& vecEnd, std::uint32_t iColor) noexcept
+{
+	auto [x1, y1, z1, c1] = MakeKey(vecStart, iColor);
+	auto [x2, y2, z2, c2] = MakeKey(vecEnd, iColor);
+
+	if (std::tie(x2, y2, z2) < std::tie(x1, y1, z1))
+	{
+		std::swap(x1, x2);
+		std::swap(y1, y2);
+		std::swap(z1, z2);
+	}
+
+	return { x1, y1, z1, x2, y2, z2, iColor };
+}
+
+// Extend an existing line sharing an endpoint with the new segment, if they continue along the same direction.
+inline bool TryMerge(Vector const& vecStart, Vector const& vecEnd, std::uint32_t iColor, float flDieTime, segment_key_t const& key) noexcept
+{
+	for (auto&& [vecShared, vecFar] : { std::pair{ vecStart, vecEnd }, std::pair{ vecEnd, vecStart } })
+	{
+		auto const SharedKey = MakeKey(vecShared, iColor);
+
+		for (auto [it, end] = m_Endpoints.equal_range(SharedKey); it != end; ++it)
+		{
+			auto const idx = it->second;
+			auto& line = m_Lines[idx];
+
+			// Which end of the existing line is touching us?
+			auto const bAtEnd = MakeKey(line.m_vecEnd, iColor) == SharedKey;
+			auto const& vecOther = bAtEnd ? line.m_vecStart : line.m_vecEnd;
+
+			auto const vecExisting = (vecShared - vecOther).Normalize();
+			auto const vecIncoming = (vecFar - vecShared).Normalize();
+
+			if (DotProduct(vecExisting, vecIncoming) < DebugDraw::COLLINEAR_COS)
+				continue;
+
+			m_Endpoints.erase(it);
+			(bAtEnd ? line.m_vecEnd : line.m_vecStart) = vecFar;
+			m_Endpoints.emplace(MakeKey(vecFar, iColor), idx);
+
+			line.m_flDieTime = std::max(line.m_flDieTime, flDieTime);
+			line.m_rgflVisibleUntil.fill(0);	// geometry changed, every client needs the new beam.
+			line.m_flPVSTime = -1.f;
+			line.m_rgAliases.push_back(key);
+			m_Aliases.try_emplace(key, idx);
+
+			++DebugDraw::m_Stats.m_iMerged;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Drop dead lines and re-index whatever survives.
+inline void Prune(float flTime) noexcept
+{
+	auto const iErased = std::erase_if(m_Lines, [flTime](line_t const& line) noexcept { return line.m_flDieTime <= flTime; });
+
+	if (!iErased)
+		return;
+
+	m_Aliases.clear();
+	m_Endpoints.clear();
+
+	for (auto&& [idx, line] : m_Lines | std::views::enumerate)
+	{
+		for (auto&& key : line.m_rgAliases)
+			m_Aliases.try_emplace(key, (std::size_t)idx);
+
+		m_Endpoints.emplace(MakeKey(line.m_vecStart, line.m_iColor), (std::size_t)idx);
+		m_Endpoints.emplace(MakeKey(line.m_vecEnd, line.m_iColor), (std::size_t)idx);
+	}
+
+	m_rgiCursor.fill(0);
+}
+
+// Who the MSG_PVS from m_vecStart of a direct draw would have reached. Evaluated once per line and frame, only for lines someone is due for.
+inline std::uint32_t PVSClients(line_t& line, std::span<edict_t* const> rgpClients, float flTime) noexcept
+{
+	if (line.m_flPVSTime == flTime)
+		return line.m_bitsPVS;
+
+	auto vecOrigin = line.m_vecStart;
+	auto const pSet = g_engfuncs.pfnSetFatPVS(vecOrigin);
+
+	line.m_bitsPVS = 0;
+	line.m_flPVSTime = flTime;
+
+	for (auto&& [iSlot, pClient] : rgpClients | std::views::enumerate)
+	{
+		if (pClient && g_engfuncs.pfnCheckVisibility(pClient, pSet))
+			line.m_bitsPVS |= 1u << iSlot;
+	}
+
+	return line.m_bitsPVS;
+}
+
+inline void SendBeam(edict_t* pClient, line_t const& line, float flLife) noexcept
+{
+	g_engfuncs.pfnMessageBegin(MSG_ONE_UNRELIABLE, SVC_TEMPENTITY, nullptr, pClient);
+	g_engfuncs.pfnWriteByte(TE_BEAMPOINTS);
+	g_engfuncs.pfnWriteCoord(line.m_vecStart.x);
+	g_engfuncs.pfnWriteCoord(line.m_vecStart.y);
+	g_engfuncs.pfnWriteCoord(line.m_vecStart.z);
+	g_engfuncs.pfnWriteCoord(line.m_vecEnd.x);
+	g_engfuncs.pfnWriteCoord(line.m_vecEnd.y);
+	g_engfuncs.pfnWriteCoord(line.m_vecEnd.z);
+	g_engfuncs.pfnWriteShort(m_iBeamSprite);
+	g_engfuncs.pfnWriteByte(0);	// starting frame
+	g_engfuncs.pfnWriteByte(0);	// frame rate
+	g_engfuncs.pfnWriteByte(std::clamp((int)std::ceil(flLife * 10.f), 1, 255));
+	g_engfuncs.pfnWriteByte(10);	// width
+	g_engfuncs.pfnWriteByte(0);	// noise
+	g_engfuncs.pfnWriteByte((line.m_iColor >> 16) & 0xFF);
+	g_engfuncs.pfnWriteByte((line.m_iColor >> 8) & 0xFF);
+	g_engfuncs.pfnWriteByte(line.m_iColor & 0xFF);
+	g_engfuncs.pfnWriteByte(255);	// brightness
+	g_engfuncs.pfnWriteByte(0);	// scroll speed
+	g_engfuncs.pfnMessageEnd();
+
+	++DebugDraw::m_Stats.m_iMsgSent;
+	DebugDraw::m_Stats.m_iBytesSent += DebugDraw::BEAMPOINTS_MSG_SIZE;
+}
+
+// Queue a line instead of sending it. Redrawing an identical line only refreshes its lifetime.
+// iLifetime is in 0.1s, same as the TE_BEAMPOINTS life byte.
+export void UTIL_DrawBeamPoints(Vector const& vecStart, Vector const& vecEnd,
+	int iLifetime, std::uint8_t bRed, std::uint8_t bGreen, std::uint8_t bBlue) noexcept
+{
+	++DebugDraw::m_Stats.m_iEnqueued;
+
+	auto const iColor = (std::uint32_t)bRed << 16 | (std::uint32_t)bGreen << 8 | (std::uint32_t)bBlue;
+	auto const flDieTime = gpGlobals->time + (float)iLifetime / 10.f;
+	auto const key = MakeKey(vecStart, vecEnd, iColor);
+
+	if (auto const it = m_Aliases.find(key); it != m_Aliases.end())
+	{
+		auto& line = m_Lines[it->second];
+		line.m_flDieTime = std::max(line.m_flDieTime, flDieTime);
+
+		++DebugDraw::m_Stats.m_iDeduped;
+		return;
+	}
+
+	// Degenerated line, nothing to see.
+	if (std::get<0>(key) == std::get<3>(key) && std::get<1>(key) == std::get<4>(key) && std::get<2>(key) == std::get<5>(key))
+		return;
+
+	if (TryMerge(vecStart, vecEnd, iColor, flDieTime, key))
+		return;
+
+	// Think() may not run for a while, e.g. a hibernating server. Don't let the queue grow on its own.
+	if (m_Lines.size() >= DebugDraw::MAX_LINES) [[unlikely]]
+	{
+		++DebugDraw::m_Stats.m_iDropped;
+		return;
+	}
+
+	auto const idx = m_Lines.size();
+
+	m_Lines.emplace_back(line_t{
+		.m_vecStart{ vecStart },
+		.m_vecEnd{ vecEnd },
+		.m_iColor{ iColor },
+		.m_flDieTime{ flDieTime },
+		.m_rgflVisibleUntil{},
+		.m_bitsPVS{},
+		.m_flPVSTime{ -1.f },
+		.m_rgAliases{ key },
+	});
+
+	m_Aliases.try_emplace(key, idx);
+	m_Endpoints.emplace(MakeKey(vecStart, iColor), idx);
+	m_Endpoints.emplace(MakeKey(vecEnd, iColor), idx);
+}
+
+export namespace DebugDraw
+{
+	// Think() without looking the players up. rgpClients holds the human clients by slot, nullptr for everyone else.
+	void Draw(std::span<edict_t* const, 32> rgpClients) noexcept
+	{
+		auto const flTime = gpGlobals->time;
+
+		Prune(flTime);
+
+		if (m_Lines.empty())
+			return;
+
+		// Nobody to draw for. Whoever joins later only needs the lines drawn after that.
+		if (std::ranges::none_of(rgpClients, std::identity{}))
+		{
+			m_Stats.m_iDropped += m_Lines.size();
+
+			m_Lines.clear();
+			m_Aliases.clear();
+			m_Endpoints.clear();
+			m_rgiCursor.fill(0);
+			return;
+		}
+
+		if (!m_iBeamSprite)
+			m_iBeamSprite = (short)g_engfuncs.pfnModelIndex("sprites/smoke.spr");
+
+		for (auto&& [iSlot, pClient] : rgpClients | std::views::enumerate)
+		{
+			if (!pClient)
+				continue;
+
+			auto& iCursor = m_rgiCursor[iSlot];
+			std::size_t iBudget = BYTES_PER_CLIENT_FRAME;
+
+			for (std::size_t i = 0; i < m_Lines.size(); ++i)
+			{
+				auto& line = m_Lines[(iCursor + i) % m_Lines.size()];
+				auto& flVisibleUntil = line.m_rgflVisibleUntil[iSlot];
+
+				if (flVisibleUntil > flTime)
+					continue;
+
+				// Out of sight costs nothing. It is sent once the client gets there, if the line still lives.
+				if (!(PVSClients(line, rgpClients, flTime) & (1u << iSlot)))
+				{
+					++m_Stats.m_iCulled;
+					continue;
+				}
+
+				if (iBudget < BEAMPOINTS_MSG_SIZE)
+				{
+					// Pick up from here next frame.
+					iCursor = (iCursor + i) % m_Lines.size();
+					++m_Stats.m_iDeferred;
+					break;
+				}
+
+				auto const flLife = std::min(line.m_flDieTime - flTime, MAX_BEAM_LIFE);
+
+				SendBeam(pClient, line, flLife);
+				flVisibleUntil = flTime + flLife;
+				iBudget -= BEAMPOINTS_MSG_SIZE;
+			}
+		}
+	}
+
+	// Call once per frame. Each client gets at most BYTES_PER_CLIENT_FRAME worth of beams, and only of lines in its PVS.
+	// Lines whose beam has faded on that client are redrawn until they die.
+	void Think() noexcept
+	{
+		auto const iMaxClients = std::min(gpGlobals->maxClients, (int)m_rgiCursor.size());
+		std::array<edict_t*, 32> rgpClients{};
+
+		for (int iIndex = 1; iIndex <= iMaxClients; ++iIndex)
+		{
+			auto const pPlayer = ent_cast<CBasePlayer*>(iIndex);
+
+			if (!pPlayer || pPlayer->IsDormant() || pPlayer->IsBot())
+				continue;
+
+			rgpClients[iIndex - 1] = pPlayer->edict();
+		}
+
+		Draw(rgpClients);
+	}
+
+	// Forget every line. The sprite index is re-resolved on next map.
+	void Clear() noexcept
+	{
+		m_Lines.clear();
+		m_Aliases.clear();
+		m_Endpoints.clear();
+		m_rgiCursor.fill(0);
+		m_iBeamSprite = 0;
+	}
+}
@@ -9,6 +9,7 @@ import hlsdk;
 
 import BaseMonster;
 import CBase;
+import DebugDraw;
 import ConsoleVar;
 import FileSystem;
 import Models;
@@ -22,37 +23,12 @@ import Improvisational;	// CZ Hostage
 import LocalNav;		// CS Hostage
 //import MonsterNav;		// HL1
 import Nav;
+import NavReport;
 //import Pathfinder;		// CZBOT
 
 
-static short s_iBeamSprite = 0;
 static bool s_bShouldPrecache = true;
 
-inline void UTIL_DrawBeamPoints(Vector const& vecStart, Vector const& vecEnd,
-	int iLifetime, std::uint8_t bRed, std::uint8_t bGreen, std::uint8_t bBlue) noexcept
-{
-	g_engfuncs.pfnMessageBegin(MSG_PVS, SVC_TEMPENTITY, vecStart, nullptr);
-	g_engfuncs.pfnWriteByte(TE_BEAMPOINTS);
-	g_engfuncs.pfnWriteCoord(vecStart.x);
-	g_engfuncs.pfnWriteCoord(vecStart.y);
-	g_engfuncs.pfnWriteCoord(vecStart.z);
-	g_engfuncs.pfnWriteCoord(vecEnd.x);
-	g_engfuncs.pfnWriteCoord(vecEnd.y);
-	g_engfuncs.pfnWriteCoord(vecEnd.z);
-	g_engfuncs.pfnWriteShort(s_iBeamSprite);
-	g_engfuncs.pfnWriteByte(0);	// starting frame
-	g_engfuncs.pfnWriteByte(0);	// frame rate
-	g_engfuncs.pfnWriteByte(iLifetime);
-	g_engfuncs.pfnWriteByte(10);	// width
-	g_engfuncs.pfnWriteByte(0);	// noise
-	g_engfuncs.pfnWriteByte(bRed);
-	g_engfuncs.pfnWriteByte(bGreen);
-	g_engfuncs.pfnWriteByte(bBlue);
-	g_engfuncs.pfnWriteByte(255);	// brightness
-	g_engfuncs.pfnWriteByte(0);	// scroll speed
-	g_engfuncs.pfnMessageEnd();
-}
-
 
 // Monitors
 
@@ -85,7 +61,7 @@ Task Task_ShowNavPath(std::ranges::input_range auto segments, Vector const vecSr
 
 	for (;;)
 	{
-		co_await TaskScheduler::NextFrame::Rank.back();;	// avoid inf loop.
+		co_await 0.1f;	// avoid inf loop.
 
 		if (segments.size() >= 1 && segments.front().how <= NT_SIMPLE)
 		{
@@ -146,8 +122,6 @@ Task Task_ShowNavPath(std::ranges::input_range auto segments, Vector const vecSr
 				);
 				break;
 			}
-
-			co_await TaskScheduler::NextFrame::Rank.back();
 		}
 	}
 
@@ -159,12 +133,9 @@ Task Task_ShowLadders() noexcept
 	for (; !TheNavLadderList.empty();)
 	{
 		for (auto&& ladder : TheNavLadderList)
-		{
 			UTIL_DrawBeamPoints(ladder.m_bottom, ladder.m_top, 9, 192, 0, 0);
-			co_await 0.1f;
-		}
 
-		co_await 0.01f;	// avoid inf loop.
+		co_await 0.1f;	// avoid inf loop.
 	}
 
 	g_engfuncs.pfnServerPrint("[PF] No ladders in NAV.\n");
@@ -197,6 +168,13 @@ void fw_GameInit_Post() noexcept
 	FileSystem::Init();
 
 	TaskScheduler::Enroll(CLocalNav::Task_LocalNav());
+
+	// Usable from a dedicated server console: +map xxx +pf_navreport [pairs]
+	g_engfuncs.pfnAddServerCommand("pf_navreport", +[]() noexcept
+	{
+		auto const iPairs = g_engfuncs.pfnCmd_Argc() >= 2 ? std::strtoul(g_engfuncs.pfnCmd_Argv(1), nullptr, 10) : 1000ul;
+		NavReport_WriteToLog(iPairs);
+	});
 }
 
 auto fw_Spawn_Post(edict_t* pEdict) noexcept -> qboolean
@@ -205,7 +183,7 @@ auto fw_Spawn_Post(edict_t* pEdict) noexcept -> qboolean
 	if (!s_bShouldPrecache)
 		return false;
 
-	s_iBeamSprite = g_engfuncs.pfnPrecacheModel("sprites/smoke.spr");
+	g_engfuncs.pfnPrecacheModel("sprites/smoke.spr");
 	g_engfuncs.pfnPrecacheModel("models/w_galil.mdl");	// random bugfix
 	g_engfuncs.pfnPrecacheModel("models/hgrunt.mdl");	// AI test
 
@@ -247,6 +225,18 @@ META_RES OnClientCommand(CBasePlayer* pPlayer, std::string_view szCmd) noexcept
 		return MRES_SUPERCEDE;
 	}
 
+	else if (szCmd == "pf_report")
+	{
+		// Any client may send this and the server stalls until the report is done. Longer runs go through pf_navreport.
+		static constexpr unsigned long MAX_CLIENT_PAIRS = 1000;
+
+		auto const iPairs = g_engfuncs.pfnCmd_Argc() >= 2 ?
+			std::min(std::strtoul(g_engfuncs.pfnCmd_Argv(1), nullptr, 10), MAX_CLIENT_PAIRS) : MAX_CLIENT_PAIRS;
+		NavReport_WriteToLog(iPairs);
+
+		return MRES_SUPERCEDE;
+	}
+
 	else if (szCmd == "pf_area")
 	{
 		TaskScheduler::Enroll(Task_ShowArea(pPlayer), 1ull << 0, true);
@@ -398,6 +388,12 @@ META_RES OnClientCommand(CBasePlayer* pPlayer, std::string_view szCmd) noexcept
 	return MRES_IGNORED;
 }
 
+void fw_StartFrame_Post() noexcept
+{
+	TaskScheduler::Think();
+	DebugDraw::Think();
+}
+
 void fw_ServerActivate_Post(edict_t* pEdictList, int edictCount, int clientMax) noexcept
 {
 	RetrieveCBaseVirtualFn();	// for Prefab
@@ -407,5 +403,7 @@ void fw_ServerDeactivate_Post() noexcept
 {
 	s_bShouldPrecache = true;
 	TaskScheduler::Clear();
+	DebugDraw::Clear();
+	StuckMetrics::Flush();
 	DestroyNavigationMap();
 }
@@ -8,37 +8,14 @@ import std;
 import hlsdk;
 
 import CBase;
+import DebugDraw;
 import Nav;
+import UtlArray;
 
 
 
 #pragma region Util
 
-inline void UTIL_DrawBeamPoints(Vector const& vecStart, Vector const& vecEnd,
-	int iLifetime, std::uint8_t bRed, std::uint8_t bGreen, std::uint8_t bBlue) noexcept
-{
-	g_engfuncs.pfnMessageBegin(MSG_PVS, SVC_TEMPENTITY, vecStart, nullptr);
-	g_engfuncs.pfnWriteByte(TE_BEAMPOINTS);
-	g_engfuncs.pfnWriteCoord(vecStart.x);
-	g_engfuncs.pfnWriteCoord(vecStart.y);
-	g_engfuncs.pfnWriteCoord(vecStart.z);
-	g_engfuncs.pfnWriteCoord(vecEnd.x);
-	g_engfuncs.pfnWriteCoord(vecEnd.y);
-	g_engfuncs.pfnWriteCoord(vecEnd.z);
-	g_engfuncs.pfnWriteShort(g_engfuncs.pfnModelIndex("sprites/smoke.spr"));
-	g_engfuncs.pfnWriteByte(0);	// starting frame
-	g_engfuncs.pfnWriteByte(0);	// frame rate
-	g_engfuncs.pfnWriteByte(iLifetime);
-	g_engfuncs.pfnWriteByte(10);	// width
-	g_engfuncs.pfnWriteByte(0);	// noise
-	g_engfuncs.pfnWriteByte(bRed);
-	g_engfuncs.pfnWriteByte(bGreen);
-	g_engfuncs.pfnWriteByte(bBlue);
-	g_engfuncs.pfnWriteByte(255);	// brightness
-	g_engfuncs.pfnWriteByte(0);	// scroll speed
-	g_engfuncs.pfnMessageEnd();
-}
-
 constexpr float NormalizeAnglePositive(float angle) noexcept
 {
 	while (angle < 0.0f)
@@ -804,8 +781,7 @@ private:
 					if (ladder->m_topForwardArea == to->area || ladder->m_topLeftArea == to->area || ladder->m_topRightArea == to->area)
 					{
 						to->ladder = ladder;
-						to->pos = ladder->m_bottom;
-						AddDirectionVector(&to->pos, ladder->m_dir, 2.0f * HalfHumanWidth);
+						to->pos = ladder->m_vecUpApproach;
 						break;
 					}
 				}
@@ -829,8 +805,7 @@ private:
 					if (ladder->m_bottomArea == to->area)
 					{
 						to->ladder = ladder;
-						to->pos = ladder->m_top;
-						AddDirectionVector(&to->pos, Opposite[ladder->m_dir], 2.0f * HalfHumanWidth);
+						to->pos = ladder->m_vecDownApproachBehind;
 						break;
 					}
 				}
@@ -1137,14 +1112,103 @@ export struct CImprov : IImprovEvent
 
 
 
+// How eager an agent class is to call itself stuck.
+export struct stuck_profile_t final
+{
+	std::string_view m_szClass{};
+	std::size_t m_iWindow{ 5 };			// samples averaged before deciding, at most CStuckMonitor::MAX_WINDOW
+	float m_flStuckVel{ 20.0f };			// cannot make this velocity too high, or actors will get "stuck" when going down ladders
+	float m_flStuckVelLadder{ 10.0f };
+	float m_flUnstuckRange{ 75.0f };
+};
+
+export inline constexpr stuck_profile_t STUCK_PROFILE_IMPROV{ .m_szClass{ "improv" } };
+export inline constexpr stuck_profile_t STUCK_PROFILE_MONSTER{ .m_szClass{ "monster" } };
+
+export struct stuck_event_t final
+{
+	std::string_view m_szClass{};
+	Vector m_vecSpot{};
+	unsigned int m_iAreaID{};	// 0 if not on the mesh
+	float m_flStartTime{};
+	float m_flDuration{};
+	bool m_bEscaped{};			// false if the owner gave up and reset instead
+};
+
+// Every stuck episode ends up here. Batched and flushed to addons/metamod/logs/<map>.stuck.csv
+export namespace StuckMetrics
+{
+	inline constexpr std::size_t FLUSH_THRESHOLD = 64;
+
+	inline std::vector<stuck_event_t> m_Pending{};
+	inline std::size_t m_iTotal{};
+
+	void Flush() noexcept
+	{
+		if (m_Pending.empty())
+			return;
+
+		char szGameDir[32]{};
+		g_engfuncs.pfnGetGameDir(szGameDir);
+
+		std::filesystem::path LogFilePath = szGameDir;
+		LogFilePath /= std::format("addons/metamod/logs/{}.stuck.csv", STRING(gpGlobals->mapname));
+
+		if (auto const LogFolder = LogFilePath.parent_path(); !std::filesystem::exists(LogFolder))
+			std::filesystem::create_directories(LogFolder);
+
+		auto const bNewFile = !std::filesystem::exists(LogFilePath);
+
+		if (auto f = std::fopen(LogFilePath.u8string().c_str(), "at"); f)
+		{
+			if (bNewFile)
+				std::println(f, "class,x,y,z,area,start,duration,escaped");
+
+			for (auto&& ev : m_Pending)
+			{
+				std::println(f, "{},{:.1f},{:.1f},{:.1f},{},{:.2f},{:.2f},{}",
+					ev.m_szClass, ev.m_vecSpot.x, ev.m_vecSpot.y, ev.m_vecSpot.z,
+					ev.m_iAreaID, ev.m_flStartTime, ev.m_flDuration, ev.m_bEscaped ? 1 : 0
+				);
+			}
+
+			std::fclose(f);
+		}
+
+		m_Pending.clear();
+	}
+
+	void Record(stuck_event_t const& ev) noexcept
+	{
+		m_Pending.push_back(ev);
+		++m_iTotal;
+
+		if (m_Pending.size() >= FLUSH_THRESHOLD)
+			Flush();
+	}
+}
+
 // Monitor improv movement and determine if it becomes stuck
 export struct CStuckMonitor
 {
-	constexpr void Reset() noexcept
+	static inline constexpr std::size_t MAX_WINDOW = 16;
+
+	CStuckMonitor() noexcept = default;
+	explicit CStuckMonitor(stuck_profile_t const& profile) noexcept : m_profile{ profile }
 	{
+		m_profile.m_iWindow = std::clamp<std::size_t>(m_profile.m_iWindow, 1, MAX_WINDOW);
+	}
+
+	void Reset() noexcept
+	{
+		// Owner gave up while we were still stuck. Worth knowing as well.
+		if (m_isStuck)
+			Report(false);
+
 		m_isStuck = false;
-		m_avgVelIndex = 0;
-		m_avgVelCount = 0;
+		m_samples.clear();
+		m_sumVel = m_sumVelSq = 0;
+		m_sumDist = m_sumDistSq = 0;
 	}
 
 	// Test if the improv has become stuck
@@ -1153,10 +1217,11 @@ export struct CStuckMonitor
 		if (m_isStuck)
 		{
 			// improv is stuck - see if it has moved far enough to be considered unstuck
-			constexpr float unstuckRange = 75.0f;
-			if ((vecCenter - m_stuckSpot).LengthSquared() > (unstuckRange * unstuckRange))
+			if ((vecCenter - m_stuckSpot).LengthSquared() > (m_profile.m_flUnstuckRange * m_profile.m_flUnstuckRange))
 			{
 				// no longer stuck
+				Report(true);
+				m_isStuck = false;
 				Reset();
 				//PrintIfWatched( "UN-STUCK\n" );
 			}
@@ -1185,26 +1250,18 @@ export struct CStuckMonitor
 
 			m_lastTime = gpGlobals->time;
 
-			// compute current velocity
-			m_avgVel[m_avgVelIndex++] = moveDist / deltaT;
+			// Only decide once the window was already full before this sample.
+			auto const bWindowFull = m_samples.size() >= m_profile.m_iWindow;
 
-			if (m_avgVelIndex == m_avgVel.size())
-				m_avgVelIndex = 0;
+			// compute current velocity
+			Push({ moveDist, moveDist / deltaT });
 
-			if (m_avgVelCount < m_avgVel.size())
-			{
-				m_avgVelCount++;
-			}
-			else
+			if (bWindowFull)
 			{
 				// we have enough samples to know if we're stuck
-				auto const avgVel =
-					std::ranges::fold_left(m_avgVel, 0.f, std::plus<>{}) / (float)m_avgVelCount;
+				auto const stuckVel = bUsingLadder ? m_profile.m_flStuckVelLadder : m_profile.m_flStuckVel;
 
-				// cannot make this velocity too high, or actors will get "stuck" when going down ladders
-				auto const stuckVel = bUsingLadder ? 10.0f : 20.0f;
-
-				if (avgVel < stuckVel)
+				if (GetMeanVelocity() < stuckVel)
 				{
 					// note when and where we initially become stuck
 					m_stuckTimer.Start();
@@ -1221,14 +1278,73 @@ export struct CStuckMonitor
 	constexpr bool IsStuck()	const noexcept { return m_isStuck; }
 	float GetDuration()			const noexcept { return m_isStuck ? m_stuckTimer.GetElapsedTime() : 0.0f; }
 
+	// Running statistics over the current window, O(1) each.
+	float GetMeanVelocity()			const noexcept { return m_samples.empty() ? 0.0f : (float)(m_sumVel / (double)m_samples.size()); }
+	float GetVelocityVariance()		const noexcept { return Variance(m_sumVel, m_sumVelSq); }
+	float GetMeanDisplacement()		const noexcept { return m_samples.empty() ? 0.0f : (float)(m_sumDist / (double)m_samples.size()); }
+	float GetDisplacementVariance()	const noexcept { return Variance(m_sumDist, m_sumDistSq); }
+
 private:
+	struct sample_t final
+	{
+		float m_flDist{};
+		float m_flVel{};
+	};
+
+	void Push(sample_t const& sample) noexcept
+	{
+		if (m_samples.size() >= m_profile.m_iWindow)
+		{
+			auto const& old = m_samples.front();
+
+			m_sumDist -= old.m_flDist;
+			m_sumDistSq -= (double)old.m_flDist * old.m_flDist;
+			m_sumVel -= old.m_flVel;
+			m_sumVelSq -= (double)old.m_flVel * old.m_flVel;
+
+			m_samples.pop_front();
+		}
+
+		m_samples.emplace_back(sample);
+
+		m_sumDist += sample.m_flDist;
+		m_sumDistSq += (double)sample.m_flDist * sample.m_flDist;
+		m_sumVel += sample.m_flVel;
+		m_sumVelSq += (double)sample.m_flVel * sample.m_flVel;
+	}
+
+	float Variance(double flSum, double flSumSq) const noexcept
+	{
+		if (m_samples.size() < 2)
+			return 0.0f;
+
+		auto const n = (double)m_samples.size();
+		return (float)std::max(0.0, (flSumSq - flSum * flSum / n) / (n - 1.0));
+	}
+
+	void Report(bool bEscaped) const noexcept
+	{
+		auto const pArea = TheNavAreaGrid.GetNavArea(m_stuckSpot);
+
+		StuckMetrics::Record(stuck_event_t{
+			.m_szClass{ m_profile.m_szClass },
+			.m_vecSpot{ m_stuckSpot },
+			.m_iAreaID{ pArea ? pArea->GetID() : 0u },
+			.m_flStartTime{ gpGlobals->time - m_stuckTimer.GetElapsedTime() },
+			.m_flDuration{ m_stuckTimer.GetElapsedTime() },
+			.m_bEscaped{ bEscaped },
+		});
+	}
+
+	stuck_profile_t m_profile{ STUCK_PROFILE_IMPROV };
+
 	bool m_isStuck{};				// if true, we are stuck
 	Vector m_stuckSpot{};			// the location where we became stuck
 	IntervalTimer m_stuckTimer{};	// how long we have been stuck
 
-	std::array<float, 5> m_avgVel{};
-	std::size_t m_avgVelIndex{};
-	std::size_t m_avgVelCount{};
+	CRingBuffer<sample_t, MAX_WINDOW> m_samples{};
+	double m_sumDist{}, m_sumDistSq{};
+	double m_sumVel{}, m_sumVelSq{};
 	Vector m_lastCentroid{};
 	float m_lastTime{};
 };
@@ -1433,7 +1549,7 @@ export struct CNavPathFollower
 	constexpr void Debug(bool status) noexcept { m_isDebug = status; }					// turn debugging on/off
 
 	constexpr bool IsStuck() const noexcept { return m_stuckMonitor.IsStuck(); }		// return true if improv is stuck
-	constexpr void ResetStuck() noexcept { m_stuckMonitor.Reset(); }
+	void ResetStuck() noexcept { m_stuckMonitor.Reset(); }
 	float GetStuckDuration() const noexcept { return m_stuckMonitor.GetDuration(); }	// return how long we've been stuck
 
 	// Do reflex avoidance movements if our "feelers" are touched
@@ -26,6 +26,64 @@ export struct CNavLadder final
 
 	bool m_isDangling{};
 
+	// Mount points, filled by BuildLadders() so no agent has to trace for them again.
+	Vector m_vecUpApproach{};		// path position in front of the bottom, for GO_LADDER_UP
+	Vector m_vecDownApproach{};		// path position in front of the top, for GO_LADDER_DOWN
+	Vector m_vecDownApproachBehind{};	// same, but on the Opposite[m_dir] side like the original CS bot
+	Vector m_vecMountBottom{};		// where a climber grabs the rungs from below
+	float m_flClimbYaw{};			// yaw of someone facing the rungs
+	float m_flClearance{};			// free space in front of the middle of the ladder
+
+	struct mount_top_t
+	{
+		Vector m_vecMins{};
+		Vector m_vecMaxs{};
+		int m_iProbes{};	// hull traces the search took, the last one found the clear spot
+	};
+
+	// Results of FindMountTop(), one per hull size. Geometry only, the users check for other monsters themselves.
+	mutable std::vector<mount_top_t> m_rgMountTops{};
+
+	// Traces saved by reusing the mount points above.
+	static inline std::size_t m_iTracesAvoided{};
+
+	// Where the walk-off search in front of the top starts.
+	[[nodiscard]] Vector MountTopStart() const noexcept
+	{
+		return m_top + Vector{ m_dirVector, 0 } * 16;
+	}
+
+	// Step out from the top one unit at a time, until the hull fits and nothing is hit within 80 units below it.
+	// The clear spot is MountTopStart() + dir * (probes - 1). Searched once per hull size, fnTrace(vecSpot, &tr) traces the hull down from vecSpot.
+	int FindMountTop(Vector const& vecMins, Vector const& vecMaxs, auto&& fnTrace) const noexcept
+	{
+		static constexpr int maxMountProbes = 64;
+
+		for (auto&& MountTop : m_rgMountTops)
+		{
+			if (MountTop.m_vecMins == vecMins && MountTop.m_vecMaxs == vecMaxs)
+				return MountTop.m_iProbes;
+		}
+
+		auto vecSpot = MountTopStart();
+		TraceResult tr{};
+		int iProbes = 0;
+
+		do
+		{
+			fnTrace(vecSpot, &tr);
+			++iProbes;
+
+			// One unit.
+			vecSpot.x += m_dirVector.x;
+			vecSpot.y += m_dirVector.y;
+
+		} while ((tr.fAllSolid || tr.fStartSolid || tr.flFraction < 1.f) && iProbes < maxMountProbes);
+
+		m_rgMountTops.emplace_back(vecMins, vecMaxs, iProbes);
+		return iProbes;
+	}
+
 	void OnNavAreaDestroy(CNavArea* dead) noexcept
 	{
 		if (dead == m_topForwardArea)
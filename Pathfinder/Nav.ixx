@@ -103,6 +103,11 @@ public:
 	CNavArea* GetNearestNavArea(const Vector& pos, bool anyZ = false) const noexcept;
 
 	constexpr bool IsValid() const noexcept { return !m_grid.empty() && m_areaCount > 0; }
+	// read-only view of the cells, row-major with m_gridSizeX columns. For diagnostics only.
+	std::span<NavAreaList const> GetCells() const noexcept { return m_grid; }
+	int GetGridSizeX() const noexcept { return m_gridSizeX; }
+	int GetGridSizeY() const noexcept { return m_gridSizeY; }
+	static constexpr float GetCellSize() noexcept { return m_cellSize; }
 	// return radio chatter place for given coordinate
 	Place GetPlace(const Vector& pos) const noexcept;
 
@@ -2044,6 +2049,7 @@ void DestroyHidingSpots() noexcept
 __forceinline void DestroyLadders() noexcept
 {
 	TheNavLadderList.clear();
+	CNavLadder::m_iTracesAvoided = 0;
 }
 
 // Free navigation map data
@@ -2190,6 +2196,49 @@ inline CNavArea* FindFirstAreaInDirection(const Vector& start, NavDirType dir, f
 
 #pragma region NAV_FILE
 
+// Everything an agent needs to get on or off this ladder. Must be called after the top and bottom are final.
+void ComputeLadderMountPoints(CNavLadder* ladder) noexcept
+{
+	static constexpr float maxClearance = 128.0f;
+
+	ladder->m_vecUpApproach = ladder->m_bottom;
+	AddDirectionVector(&ladder->m_vecUpApproach, ladder->m_dir, 2.0f * HalfHumanWidth);
+
+	ladder->m_vecDownApproach = ladder->m_top;
+	AddDirectionVector(&ladder->m_vecDownApproach, ladder->m_dir, 2.0f * HalfHumanWidth);
+
+	ladder->m_vecDownApproachBehind = ladder->m_top;
+	AddDirectionVector(&ladder->m_vecDownApproachBehind, Opposite[ladder->m_dir], 2.0f * HalfHumanWidth);
+
+	ladder->m_vecMountBottom = ladder->m_bottom + Vector{ ladder->m_dirVector, 0 } * 17;
+	ladder->m_flClimbYaw = (float)(-ladder->m_dirVector).Yaw();
+
+	// Monsters are human sized, and a monster hull trace picks the clip hull by size, so human_hull is what they would trace.
+	// Other sizes are searched on their first use.
+	ladder->m_rgMountTops.clear();
+	ladder->FindMountTop(VEC_HUMAN_HULL_MIN, VEC_HUMAN_HULL_MAX, [&](Vector const& vecSpot, TraceResult* ptr) noexcept
+	{
+		g_engfuncs.pfnTraceHull(
+			vecSpot,
+			Vector{ vecSpot.x, vecSpot.y, vecSpot.z - 80.f },
+			ignore_monsters | dont_ignore_glass,
+			human_hull,
+			ladder->m_entity->edict(),
+			ptr
+		);
+	});
+
+	TraceResult tr{};
+
+	// How far out can we step from the middle of the rungs?
+	auto const vecMiddle = (ladder->m_top + ladder->m_bottom) / 2.0f;
+	auto vecOut = vecMiddle;
+	AddDirectionVector(&vecOut, ladder->m_dir, maxClearance);
+
+	g_engfuncs.pfnTraceLine(vecMiddle, vecOut, ignore_monsters | dont_ignore_glass, ladder->m_entity->edict(), &tr);
+	ladder->m_flClearance = tr.fStartSolid ? 0.0f : tr.flFraction * maxClearance;
+}
+
 // For each ladder in the map, create a navigation representation of it.
 void BuildLadders() noexcept
 {
@@ -2391,6 +2440,8 @@ void BuildLadders() noexcept
 			if (ladder.m_bottom.z - bottomSpot.z > HumanHeight)
 				ladder.m_isDangling = true;
 		}
+
+		ComputeLadderMountPoints(&ladder);
 	}
 }
 
@@ -0,0 +1,332 @@
+export module NavReport;
+
+import std;
+import hlsdk;
+
+import Improvisational;
+import Nav;
+
+
+
+struct component_info_t
+{
+	std::vector<std::size_t> m_rgiSizes{};	// indexed by component
+	std::unordered_map<CNavArea const*, std::size_t> m_Membership{};
+};
+
+static auto ComputeComponents(std::span<CNavArea* const> rgpAreas) noexcept -> component_info_t
+{
+	component_info_t ret{};
+	ret.m_Membership.reserve(rgpAreas.size());
+
+	// Treat every link as two-way. One-way links are reported separately.
+	std::unordered_map<CNavArea const*, std::vector<CNavArea const*>> Graph{};
+	Graph.reserve(rgpAreas.size());
+
+	for (auto&& pArea : rgpAreas)
+	{
+		auto& vSelf = Graph[pArea];
+
+		for (int dir = NORTH; dir < NUM_DIRECTIONS; ++dir)
+		{
+			for (auto&& conn : *pArea->GetAdjacentList((NavDirType)dir))
+			{
+				if (!conn.area)
+					continue;
+
+				vSelf.push_back(conn.area);
+				Graph[conn.area].push_back(pArea);
+			}
+		}
+
+		for (auto&& Ladders : { pArea->GetLadderList(LADDER_UP), pArea->GetLadderList(LADDER_DOWN) })
+		{
+			for (auto&& pLadder : *Ladders)
+			{
+				for (auto&& pOther : { pLadder->m_bottomArea, pLadder->m_topForwardArea, pLadder->m_topLeftArea, pLadder->m_topRightArea, pLadder->m_topBehindArea })
+				{
+					if (!pOther || pOther == pArea)
+						continue;
+
+					vSelf.push_back(pOther);
+					Graph[pOther].push_back(pArea);
+				}
+			}
+		}
+	}
+
+	std::vector<CNavArea const*> Stack{};
+
+	for (auto&& pArea : rgpAreas)
+	{
+		if (ret.m_Membership.contains(pArea))
+			continue;
+
+		auto const iComponent = ret.m_rgiSizes.size();
+		std::size_t iSize = 0;
+
+		Stack.push_back(pArea);
+		ret.m_Membership[pArea] = iComponent;
+
+		while (!Stack.empty())
+		{
+			auto const pCur = Stack.back();
+			Stack.pop_back();
+			++iSize;
+
+			for (auto&& pNext : Graph[pCur])
+			{
+				if (ret.m_Membership.try_emplace(pNext, iComponent).second)
+					Stack.push_back(pNext);
+			}
+		}
+
+		ret.m_rgiSizes.push_back(iSize);
+	}
+
+	return ret;
+}
+
+// {count: occurrences} as a JSON object. Keys are ordered.
+static auto HistogramToJson(std::map<std::size_t, std::size_t> const& Histogram) noexcept -> std::string
+{
+	std::string ret{ "{" };
+
+	for (auto&& [iKey, iCount] : Histogram)
+		std::format_to(std::back_inserter(ret), "{}\"{}\": {}", ret.size() > 1 ? ", " : "", iKey, iCount);
+
+	ret += '}';
+	return ret;
+}
+
+// Nearest power-of-two bucket, 0 stays 0. Keeps the grid histogram short on large maps.
+static constexpr std::size_t Bucket(std::size_t i) noexcept
+{
+	return i == 0 ? 0 : std::bit_floor(i);
+}
+
+// Integrity and pathing cost of the loaded .nav, as a JSON document.
+// Everything is read back from what CNavArea::Load/PostLoad and BuildLadders() produced.
+// iPairs random area pairs are fed through NavAreaBuildPath() with a fixed seed, so runs are comparable across map versions.
+export auto NavReport_Generate(std::size_t iPairs, std::uint32_t iSeed = 0x4E41'5652) noexcept -> std::string
+{
+	std::vector<CNavArea*> rgpAreas{};
+	for (auto&& area : TheNavAreaList)
+		rgpAreas.push_back(&area);
+
+	// Sort by ID so the sweep picks the same pairs regardless of load order.
+	std::ranges::sort(rgpAreas, {}, &CNavArea::GetID);
+
+	std::string ret{};
+	auto out = std::back_inserter(ret);
+
+	std::format_to(out, "{{\n\t\"map\": \"{}\",\n\t\"areas\": {},\n", STRING(gpGlobals->mapname), rgpAreas.size());
+
+	// Connectivity
+
+	auto const Components = ComputeComponents(rgpAreas);
+	auto rgiSizes = Components.m_rgiSizes;
+	std::ranges::sort(rgiSizes, std::ranges::greater{});
+
+	std::format_to(out, "\t\"components\": {{\"count\": {}, \"largest\": {}, \"islands\": {}, \"sizes\": [",
+		rgiSizes.size(),
+		rgiSizes.empty() ? 0 : rgiSizes.front(),
+		rgiSizes.empty() ? 0 : rgiSizes.size() - 1
+	);
+	for (auto&& [i, iSize] : rgiSizes | std::views::take(32) | std::views::enumerate)
+		std::format_to(out, "{}{}", i ? ", " : "", iSize);
+	ret += "]},\n";
+
+	// Degrees & broken links
+
+	std::map<std::size_t, std::size_t> DegreeHistogram{};
+	std::size_t iBrokenConnections = 0, iOneWayConnections = 0, iDeadEnds = 0;
+
+	for (auto&& pArea : rgpAreas)
+	{
+		std::size_t iDegree = 0;
+
+		for (int dir = NORTH; dir < NUM_DIRECTIONS; ++dir)
+		{
+			for (auto&& conn : *pArea->GetAdjacentList((NavDirType)dir))
+			{
+				if (!conn.area)
+				{
+					++iBrokenConnections;
+					continue;
+				}
+
+				++iDegree;
+
+				if (!conn.area->IsConnected(pArea, NUM_DIRECTIONS))
+					++iOneWayConnections;
+			}
+		}
+
+		iDegree += pArea->GetLadderList(LADDER_UP)->size() + pArea->GetLadderList(LADDER_DOWN)->size();
+
+		if (iDegree == 0)
+			++iDeadEnds;
+
+		++DegreeHistogram[iDegree];
+	}
+
+	std::format_to(out, "\t\"connections\": {{\"broken\": {}, \"one_way\": {}, \"isolated_areas\": {}, \"degree_histogram\": {}}},\n",
+		iBrokenConnections, iOneWayConnections, iDeadEnds, HistogramToJson(DegreeHistogram)
+	);
+
+	// Grid
+
+	std::map<std::size_t, std::size_t> CellHistogram{};
+	std::size_t iMaxCell = 0, iMaxCellIndex = 0;
+
+	for (auto&& [idx, Cell] : TheNavAreaGrid.GetCells() | std::views::enumerate)
+	{
+		++CellHistogram[Bucket(Cell.size())];
+
+		if (Cell.size() > iMaxCell)
+		{
+			iMaxCell = Cell.size();
+			iMaxCellIndex = (std::size_t)idx;
+		}
+	}
+
+	auto const iGridX = std::max(TheNavAreaGrid.GetGridSizeX(), 1);
+
+	std::format_to(out, "\t\"grid\": {{\"cell_size\": {}, \"size_x\": {}, \"size_y\": {}, \"max_areas_in_cell\": {}, \"max_cell\": [{}, {}], \"areas_per_cell_histogram\": {}}},\n",
+		CNavAreaGrid::GetCellSize(), TheNavAreaGrid.GetGridSizeX(), TheNavAreaGrid.GetGridSizeY(),
+		iMaxCell, iMaxCellIndex % iGridX, iMaxCellIndex / iGridX,
+		HistogramToJson(CellHistogram)
+	);
+
+	// Ladders
+
+	std::size_t iLadders = 0, iNoBottom = 0, iNoTop = 0, iDangling = 0, iCramped = 0;
+
+	for (auto&& ladder : TheNavLadderList)
+	{
+		++iLadders;
+
+		if (!ladder.m_bottomArea)
+			++iNoBottom;
+
+		if (!ladder.m_topForwardArea && !ladder.m_topLeftArea && !ladder.m_topRightArea && !ladder.m_topBehindArea)
+			++iNoTop;
+
+		if (ladder.m_isDangling)
+			++iDangling;
+
+		if (ladder.m_flClearance < 2.0f * HalfHumanWidth)
+			++iCramped;
+	}
+
+	std::format_to(out, "\t\"ladders\": {{\"count\": {}, \"no_bottom_area\": {}, \"no_top_area\": {}, \"dangling\": {}, \"cramped\": {}, \"mount_traces_avoided\": {}}},\n",
+		iLadders, iNoBottom, iNoTop, iDangling, iCramped, CNavLadder::m_iTracesAvoided
+	);
+
+	// Hiding spots & approach areas
+
+	std::unordered_set<HidingSpot const*> OwnedSpots{};
+	std::size_t iApproaches = 0, iApproachUnresolved = 0, iApproachOtherComponent = 0;
+
+	for (auto&& pArea : rgpAreas)
+	{
+		OwnedSpots.insert_range(*pArea->GetHidingSpotList());
+
+		for (int i = 0; i < pArea->GetApproachInfoCount(); ++i)
+		{
+			auto const pInfo = pArea->GetApproachInfo(i);
+			++iApproaches;
+
+			if (!pInfo->here.area)
+				++iApproachUnresolved;
+
+			// Approaching from somewhere we can't possibly walk from.
+			else if (Components.m_Membership.at(pInfo->here.area) != Components.m_Membership.at(pArea))
+				++iApproachOtherComponent;
+		}
+	}
+
+	auto const iSpots = (std::size_t)std::ranges::distance(TheHidingSpotList);
+	auto const iOrphanSpots = (std::size_t)std::ranges::count_if(TheHidingSpotList, [&](HidingSpot const& spot) noexcept { return !OwnedSpots.contains(&spot); });
+
+	std::format_to(out, "\t\"hiding_spots\": {{\"count\": {}, \"orphaned\": {}}},\n", iSpots, iOrphanSpots);
+	std::format_to(out, "\t\"approach_areas\": {{\"count\": {}, \"unresolved\": {}, \"unreachable\": {}}},\n",
+		iApproaches, iApproachUnresolved, iApproachOtherComponent
+	);
+
+	// A* sweep
+
+	std::mt19937 Rng{ iSeed };
+	std::move_only_function<float(CNavArea*, CNavArea*, const CNavLadder*) noexcept> CostFunc{ HostagePathCost{} };
+	std::vector<double> rgflMicroseconds{};
+	std::size_t iFound = 0;
+
+	if (!rgpAreas.empty())
+	{
+		std::uniform_int_distribution<std::size_t> Dist{ 0, rgpAreas.size() - 1 };
+		rgflMicroseconds.reserve(iPairs);
+
+		for (std::size_t i = 0; i < iPairs; ++i)
+		{
+			auto const pStart = rgpAreas[Dist(Rng)];
+			auto const pGoal = rgpAreas[Dist(Rng)];
+
+			auto const t0 = std::chrono::steady_clock::now();
+			auto const bFound = NavAreaBuildPath(pStart, pGoal, pGoal->GetCenter(), CostFunc);
+			auto const t1 = std::chrono::steady_clock::now();
+
+			rgflMicroseconds.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+			iFound += bFound;
+		}
+	}
+
+	std::ranges::sort(rgflMicroseconds);
+
+	auto const fnPercentile = [&](double p) noexcept -> double
+	{
+		if (rgflMicroseconds.empty())
+			return 0;
+
+		return rgflMicroseconds[std::min(rgflMicroseconds.size() - 1, (std::size_t)(p * (double)rgflMicroseconds.size()))];
+	};
+	auto const flTotal = std::ranges::fold_left(rgflMicroseconds, 0.0, std::plus<>{});
+
+	std::format_to(out, "\t\"astar\": {{\"pairs\": {}, \"found\": {}, \"total_us\": {:.1f}, \"mean_us\": {:.2f}, \"p50_us\": {:.2f}, \"p99_us\": {:.2f}, \"max_us\": {:.2f}}}\n}}\n",
+		rgflMicroseconds.size(), iFound, flTotal,
+		rgflMicroseconds.empty() ? 0.0 : flTotal / (double)rgflMicroseconds.size(),
+		fnPercentile(0.5), fnPercentile(0.99),
+		rgflMicroseconds.empty() ? 0.0 : rgflMicroseconds.back()
+	);
+
+	return ret;
+}
+
+// Load the .nav of current map if needed and dump the report next to the other metamod logs.
+export void NavReport_WriteToLog(std::size_t iPairs) noexcept
+{
+	if (auto const err = LoadNavigationMap(); err != NAV_OK)
+	{
+		g_engfuncs.pfnServerPrint(std::format("[PF] Cannot report on NAV: error {}.\n", std::to_underlying(err)).c_str());
+		return;
+	}
+
+	char szGameDir[32]{};
+	g_engfuncs.pfnGetGameDir(szGameDir);
+
+	std::filesystem::path LogFilePath = szGameDir;
+	LogFilePath /= std::format("addons/metamod/logs/{}.navreport.json", STRING(gpGlobals->mapname));
+
+	if (auto const LogFolder = LogFilePath.parent_path(); !std::filesystem::exists(LogFolder))
+		std::filesystem::create_directories(LogFolder);
+
+	auto const szReport = NavReport_Generate(iPairs);
+
+	if (auto f = std::fopen(LogFilePath.u8string().c_str(), "wt"); f)
+	{
+		std::print(f, "{}", szReport);
+		std::fclose(f);
+	}
+
+	g_engfuncs.pfnServerPrint(std::format("[PF] NAV report written to {}\n", LogFilePath.u8string()).c_str());
+}
@@ -0,0 +1,36 @@
+import std;
+
+import Test;
+
+
+// Test.DebugDraw.cpp
+extern void TestDebugDraw() noexcept;
+//
+
+// Test.DynExpr.cpp
+extern void TestDynExpr() noexcept;
+//
+
+// Test.ImpactBudget.cpp
+extern void TestImpactBudget() noexcept;
+//
+
+// Test.Profiler.cpp
+extern void TestProfiler() noexcept;
+//
+
+// Test.TextureCache.cpp
+extern void TestTextureCache() noexcept;
+//
+
+int main() noexcept
+{
+	TestDebugDraw();
+	TestDynExpr();
+	TestImpactBudget();
+	TestProfiler();
+	TestTextureCache();
+
+	std::println("{} checks, {} failed.", Test::m_iChecks, Test::m_iFailures);
+	return Test::m_iFailures ? 1 : 0;
+}
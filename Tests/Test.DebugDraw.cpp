@@ -0,0 +1,152 @@
+import std;
+import hlsdk;
+
+import DebugDraw;
+
+import Test;
+
+
+// Three human clients: slot 0 sees the whole map, slot 1 sees nothing, slot 2 only sees the x < 0 half.
+inline std::array<edict_t, 3> g_rgClients{};
+inline std::array<std::uint8_t, 2> g_rgPVS{};	// what SetFatPVS() hands out, [0] for x >= 0 and [1] for x < 0
+
+// Every message the engine would have sent, by client slot.
+struct message_sink_t
+{
+	struct beam_t
+	{
+		std::size_t m_iSlot{};
+		float m_flStartX{};
+	};
+
+	std::array<std::size_t, 32> m_rgiFrameBytes{};
+	std::vector<beam_t> m_rgBeams{};
+	std::size_t m_iNonUnicast{};
+
+	std::size_t m_iSlot{};
+	std::size_t m_iCoords{};
+	float m_flStartX{};
+};
+
+inline message_sink_t g_Sink{};
+
+static void InstallSink() noexcept
+{
+	Test::Install(g_engfuncs.pfnModelIndex, [](auto) noexcept { return 1; });
+
+	Test::Install(g_engfuncs.pfnSetFatPVS, [](auto const& vecOrigin) noexcept -> unsigned char*
+	{
+		float flX{};
+
+		if constexpr (std::is_pointer_v<std::remove_cvref_t<decltype(vecOrigin)>>)
+			flX = vecOrigin[0];
+		else
+			flX = vecOrigin.x;
+
+		return &g_rgPVS[flX < 0.f ? 1 : 0];
+	});
+
+	Test::Install(g_engfuncs.pfnCheckVisibility, [](auto pEntity, auto pSet) noexcept
+	{
+		if (pEntity == &g_rgClients[0])
+			return 1;
+
+		if (pEntity == &g_rgClients[2])
+			return pSet == &g_rgPVS[1] ? 1 : 0;
+
+		return 0;
+	});
+
+	Test::Install(g_engfuncs.pfnMessageBegin, [](auto iDest, auto, auto, auto pClient) noexcept
+	{
+		if (iDest != MSG_ONE_UNRELIABLE || !pClient)
+		{
+			++g_Sink.m_iNonUnicast;
+			return;
+		}
+
+		g_Sink.m_iSlot = (std::size_t)(pClient - g_rgClients.data());
+		g_Sink.m_iCoords = 0;
+		g_Sink.m_rgiFrameBytes[g_Sink.m_iSlot] += 1;	// svc_temp_entity
+	});
+
+	Test::Install(g_engfuncs.pfnWriteByte, [](auto) noexcept { g_Sink.m_rgiFrameBytes[g_Sink.m_iSlot] += 1; });
+	Test::Install(g_engfuncs.pfnWriteShort, [](auto) noexcept { g_Sink.m_rgiFrameBytes[g_Sink.m_iSlot] += 2; });
+
+	Test::Install(g_engfuncs.pfnWriteCoord, [](auto flValue) noexcept
+	{
+		if (g_Sink.m_iCoords++ == 0)
+			g_Sink.m_flStartX = (float)flValue;
+
+		g_Sink.m_rgiFrameBytes[g_Sink.m_iSlot] += 2;
+	});
+
+	Test::Install(g_engfuncs.pfnMessageEnd, []() noexcept
+	{
+		g_Sink.m_rgBeams.emplace_back(g_Sink.m_iSlot, g_Sink.m_flStartX);
+	});
+}
+
+void TestDebugDraw() noexcept
+{
+	static constexpr int LINES = 120;
+
+	globalvars_t Globals{};
+	Globals.time = 10.f;
+	Globals.maxClients = 32;
+	gpGlobals = &Globals;
+
+	InstallSink();
+	DebugDraw::Clear();
+	DebugDraw::m_Stats = {};
+
+	std::array<edict_t*, 32> rgpClients{ &g_rgClients[0], &g_rgClients[1], &g_rgClients[2] };
+
+	// Half of them left of the origin. 25 seconds, so nothing fades or dies during the test.
+	for (int i = 0; i < LINES; ++i)
+	{
+		auto const flX = i % 2 ? -64.f * (float)(i + 1) : 64.f * (float)(i + 1);
+		UTIL_DrawBeamPoints(Vector{ flX, 0.f, 0.f }, Vector{ flX, 0.f, 32.f }, 250, 255, 0, 0);
+	}
+
+	static constexpr auto LINES_PER_FRAME = DebugDraw::BYTES_PER_CLIENT_FRAME / DebugDraw::BEAMPOINTS_MSG_SIZE;
+	static constexpr auto FRAMES_FOR_ALL = (LINES + LINES_PER_FRAME - 1) / LINES_PER_FRAME;
+	static constexpr auto FRAMES_FOR_HALF = (LINES / 2 + LINES_PER_FRAME - 1) / LINES_PER_FRAME;
+
+	std::array<std::size_t, 3> rgiReceived{};
+	std::size_t iOverBudget{}, iWrongHalf{};
+
+	for (std::size_t iFrame = 0; iFrame < FRAMES_FOR_ALL + 2; ++iFrame)
+	{
+		g_Sink.m_rgiFrameBytes.fill(0);
+		g_Sink.m_rgBeams.clear();
+
+		DebugDraw::Draw(rgpClients);
+
+		for (auto&& iBytes : g_Sink.m_rgiFrameBytes)
+			iOverBudget += iBytes > DebugDraw::BYTES_PER_CLIENT_FRAME;
+
+		for (auto&& Beam : g_Sink.m_rgBeams)
+		{
+			++rgiReceived[Beam.m_iSlot];
+			iWrongHalf += Beam.m_iSlot == 2 && Beam.m_flStartX >= 0.f;
+		}
+
+		// Lines out of a client's PVS must not eat into its budget.
+		if (iFrame + 1 == FRAMES_FOR_HALF)
+			Test::Check(rgiReceived[2] == LINES / 2, std::format("slot 2 got {} of its {} lines after {} frames", rgiReceived[2], LINES / 2, FRAMES_FOR_HALF));
+
+		Globals.time += 0.01f;
+	}
+
+	Test::Check(iOverBudget == 0, std::format("{} client frames over {} bytes", iOverBudget, DebugDraw::BYTES_PER_CLIENT_FRAME));
+	Test::Check(g_Sink.m_iNonUnicast == 0, "beams are only sent to one client at a time");
+	Test::Check(rgiReceived[0] == LINES, std::format("slot 0 sees everything, got {} of {}", rgiReceived[0], LINES));
+	Test::Check(rgiReceived[1] == 0, std::format("slot 1 sees nothing, got {}", rgiReceived[1]));
+	Test::Check(rgiReceived[2] == LINES / 2, std::format("slot 2 sees half, got {} of {}", rgiReceived[2], LINES / 2));
+	Test::Check(iWrongHalf == 0, std::format("{} beams sent to slot 2 outside its PVS", iWrongHalf));
+	Test::Check(DebugDraw::m_Stats.m_iCulled > 0, "culled lines are counted");
+
+	DebugDraw::Clear();
+	gpGlobals = nullptr;
+}
@@ -0,0 +1,325 @@
+﻿#include <assert.h>
+
+import std;
+import hlsdk;
+
+import Test;
+
+using namespace std;
+
+#include "../WeaponSystem/DynExpr.hpp"
+
+
+// DynExpr.cpp
+extern void InitializeDynExpr() noexcept;
+//
+
+// CLIP, AMMO and MAXCLIP, the order InitializeDynExpr() declares them in.
+inline constexpr double FRAME[] = { 3, 40, 12 };
+
+// DynExpr.golden.txt came from the interpreter before programs were compiled, built against glibc.
+// The CRT here may round sin(), pow() and friends differently in the last bit.
+inline constexpr double TOLERANCE = 1e-9;
+
+// Next to this file, whatever directory the test is run from.
+static auto ReadLines(string_view szFile) noexcept -> vector<string>
+{
+	auto const Path = std::filesystem::path{ std::source_location::current().file_name() }.replace_filename(szFile);
+	std::ifstream f{ Path, std::ios::binary };
+	vector<string> ret{};
+
+	for (string szLine{}; std::getline(f, szLine); )
+	{
+		if (szLine.ends_with('\r'))
+			szLine.pop_back();
+
+		ret.emplace_back(std::move(szLine));
+	}
+
+	return ret;
+}
+
+[[nodiscard]] static bool Close(double lhs, double rhs) noexcept
+{
+	if (std::isnan(lhs) || std::isnan(rhs))
+		return std::isnan(lhs) && std::isnan(rhs);
+
+	if (lhs == rhs)
+		return true;
+
+	return std::abs(lhs - rhs) <= TOLERANCE * std::max({ 1.0, std::abs(lhs), std::abs(rhs) });
+}
+
+// "ERR", "D <value> <bits in hex>" or "V <x> <y> <z>".
+[[nodiscard]] static bool Matches(string_view szGolden, expected<DynExpr::value_t, string> const& Result) noexcept
+{
+	if (szGolden == "ERR")
+		return !Result.has_value();
+
+	if (!Result.has_value())
+		return false;
+
+	auto Fields = szGolden | std::views::split(' ') | std::views::transform([](auto&& r) noexcept { return string_view{ r.begin(), r.end() }; });
+	vector<string_view> const rgszFields{ Fields.begin(), Fields.end() };
+
+	if (rgszFields[0] == "D" && rgszFields.size() == 3)
+	{
+		std::uint64_t iBits{};
+		std::from_chars(rgszFields[2].data(), rgszFields[2].data() + rgszFields[2].size(), iBits, 16);
+
+		auto const p = std::get_if<double>(&*Result);
+		return p && Close(*p, bit_cast<double>(iBits));
+	}
+
+	if (rgszFields[0] == "V" && rgszFields.size() == 4)
+	{
+		std::array<float, 3> rgflGolden{};
+
+		for (auto&& [szField, flValue] : std::views::zip(rgszFields | std::views::drop(1), rgflGolden))
+			std::from_chars(szField.data(), szField.data() + szField.size(), flValue);
+
+		auto const p = std::get_if<Vector>(&*Result);
+
+		// Stored as float, so only float precision to compare against.
+		auto const fnClose = [](float lhs, float rhs) noexcept { return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs)) || std::abs(lhs - rhs) <= 1e-6f * std::max({ 1.f, std::abs(lhs), std::abs(rhs) }); };
+
+		return p && fnClose(p->x, rgflGolden[0]) && fnClose(p->y, rgflGolden[1]) && fnClose(p->z, rgflGolden[2]);
+	}
+
+	return false;
+}
+
+[[nodiscard]] static auto Describe(expected<DynExpr::value_t, string> const& Result) noexcept -> string
+{
+	if (!Result)
+		return Result.error();
+
+	if (auto const p = std::get_if<double>(&*Result))
+		return std::format("D {}", *p);
+
+	if (auto const p = std::get_if<Vector>(&*Result))
+		return std::format("V {} {} {}", p->x, p->y, p->z);
+
+	return std::format("type #{}", Result->index());
+}
+
+// Randomly generated expressions over every operator and function a QC script may use, plus broken ones.
+static void TestGolden(vector<string> const& rgszCorpus) noexcept
+{
+	auto const rgszGolden = ReadLines("DynExpr.golden.txt");
+
+	if (!Test::Check(!rgszCorpus.empty() && rgszCorpus.size() == rgszGolden.size(), std::format("{} expressions against {} golden results", rgszCorpus.size(), rgszGolden.size())))
+		return;
+
+	std::size_t iMismatches{};
+
+	for (auto&& [szExpr, szGolden] : std::views::zip(rgszCorpus, rgszGolden))
+	{
+		auto const Result = DynExpr::Compile(szExpr).and_then([](DynExpr::Program const& prog) noexcept { return DynExpr::Execute<DynExpr::value_t>(prog, FRAME); });
+
+		if (!Matches(szGolden, Result) && ++iMismatches <= 10)
+			Test::Check(false, std::format("'{}': expected {}, got {}", szExpr, szGolden, Describe(Result)));
+	}
+
+	Test::Check(iMismatches == 0, std::format("{} of {} expressions differ from the interpreter", iMismatches, rgszCorpus.size()));
+}
+
+static void TestFolding() noexcept
+{
+	auto const fnCount = [](DynExpr::Program const& prog, DynExpr::EOpCode iOpCode) noexcept
+	{
+		return std::ranges::count(prog.m_Instructions, iOpCode, &DynExpr::instr_t::m_OpCode);
+	};
+
+	// Nothing but fixed constants and pure functions: one literal.
+	if (auto const prog = DynExpr::Compile("vec3(1, 2, 3) ⋅ vec3(4, 5, 6) + pi"); Test::Check(prog.has_value(), "constant expression compiles"))
+	{
+		auto const Result = DynExpr::Execute<double>(*prog);
+
+		Test::Check(prog->m_Instructions.size() == 1 && prog->m_iUnfoldedSize > 1, std::format("constant expression folded to {} instruction(s)", prog->m_Instructions.size()));
+		Test::Check(Result && *Result == 32 + std::numbers::pi, "folded value");
+	}
+
+	// The constant part goes, the variable stays.
+	if (auto const prog = DynExpr::Compile("pi * 2 + CLIP"); Test::Check(prog.has_value(), "mixed expression compiles"))
+	{
+		auto const Result = DynExpr::Execute<double>(*prog, FRAME);
+
+		Test::Check(prog->m_Instructions.size() == 3 && fnCount(*prog, DynExpr::EOpCode::PushVar) == 1, std::format("mixed expression has {} instruction(s)", prog->m_Instructions.size()));
+		Test::Check(Result && *Result == std::numbers::pi * 2 + FRAME[0], "mixed value");
+	}
+
+	// rand() must be called on each evaluation.
+	if (auto const prog = DynExpr::Compile("rand(1, 2) + 1"); Test::Check(prog.has_value(), "impure expression compiles"))
+	{
+		auto const bCallsRand = std::ranges::any_of(prog->m_Instructions, [](DynExpr::instr_t const& ins) noexcept
+		{
+			return ins.m_OpCode == DynExpr::EOpCode::Call && !ins.m_pFunction->m_bPure;
+		});
+
+		Test::Check(bCallsRand, "impure call not folded");
+	}
+
+	// Folding never grows the program or its stack.
+	if (auto const prog = DynExpr::Compile("-min(MAXCLIP - CLIP, AMMO)"); Test::Check(prog.has_value(), "pistol expression compiles"))
+	{
+		auto const Result = DynExpr::Execute<double>(*prog, FRAME);
+
+		Test::Check(prog->m_Instructions.size() <= prog->m_iUnfoldedSize && prog->m_iMaxDepth <= 3, "pistol expression size");
+		Test::Check(Result && *Result == -std::min(FRAME[2] - FRAME[0], FRAME[1]), "pistol expression value");
+	}
+}
+
+// Each element bit for bit the same as its own scalar evaluation.
+static void TestBatch(vector<string> const& rgszCorpus) noexcept
+{
+	static constexpr std::size_t N = 100;	// Not a multiple of the lane count of deep programs.
+
+	vector<double> Frames(std::size(FRAME) * N);
+	vector<DynExpr::value_t> Results(N);
+
+	for (std::size_t v = 0; v < std::size(FRAME); ++v)
+	{
+		for (std::size_t i = 0; i < N; ++i)
+			Frames[v * N + i] = (double)((i * 7 + v * 13) % 50) - 5;
+	}
+
+	std::size_t iChecked{}, iMismatches{};
+
+	for (auto&& szExpr : rgszCorpus)
+	{
+		auto const prog = DynExpr::Compile(szExpr);
+
+		if (!prog || !std::ranges::all_of(prog->m_Instructions, [](DynExpr::instr_t const& ins) noexcept { return ins.m_OpCode != DynExpr::EOpCode::Call || ins.m_pFunction->m_bPure; }))
+			continue;
+
+		auto const Batch = DynExpr::ExecuteBatch<DynExpr::value_t>(*prog, Frames, span{ Results });
+
+		for (std::size_t i = 0; i < N; ++i)
+		{
+			double const Frame[] = { Frames[i], Frames[N + i], Frames[2 * N + i] };
+			auto const Scalar = DynExpr::Execute<DynExpr::value_t>(*prog, Frame);
+
+			++iChecked;
+
+			if (Scalar.has_value() != Batch.has_value())
+				++iMismatches;
+			else if (Scalar)
+			{
+				iMismatches += Scalar->index() != Results[i].index()
+					|| std::visit([&](auto const& lhs) noexcept { return std::memcmp(&lhs, &std::get<std::decay_t<decltype(lhs)>>(Results[i]), sizeof(lhs)) != 0; }, *Scalar);
+			}
+		}
+	}
+
+	Test::Check(iChecked > 0, "some expressions ran batched");
+	Test::Check(iMismatches == 0, std::format("{} of {} batched elements differ from scalar", iMismatches, iChecked));
+}
+
+// Looking up never inserts, every bound name finds its way back, the operator trie agrees with the pool.
+static void TestSymbols(vector<string> const& rgszCorpus) noexcept
+{
+	auto const fnTableSizes = []() noexcept
+	{
+		return std::array{ DynExpr::m_Symbols.m_Names.size(), DynExpr::m_Functions.size(), DynExpr::m_Constants.size(), DynExpr::m_Variables.size(), DynExpr::m_ClassMembers.size() };
+	};
+
+	auto const TableSizes = fnTableSizes();
+
+	for (auto&& szExpr : rgszCorpus)
+		std::ignore = DynExpr::Compile(szExpr).and_then([](DynExpr::Program const& prog) noexcept { return DynExpr::Execute<DynExpr::value_t>(prog, FRAME); });
+
+	for (auto&& szExpr : { "foo(3)", "CLIP.w", "vec4(1, 2, 3, 4)", "1 $ 2", "NotAConstant" })
+		Test::Check(!DynExpr::Compile(szExpr).has_value(), std::format("'{}' is rejected", szExpr));
+
+	Test::Check(fnTableSizes() == TableSizes, "symbol tables unchanged by compiling and running");
+
+	std::size_t iLost{}, iOperators{};
+	auto const fnCheckKeys = [&](auto const& Table) noexcept
+	{
+		for (auto&& szName : Table.keys())
+		{
+			auto const id = DynExpr::m_Symbols.Find(szName);
+
+			iLost += id == DynExpr::symbol_pool_t::NPOS || DynExpr::m_Symbols.m_Names[id] != szName || !Table.find(szName);
+
+			if (DynExpr::IsOperator(szName))
+			{
+				++iOperators;
+				iLost += DynExpr::m_OpTrie.Find(szName) != id;
+			}
+		}
+	};
+
+	fnCheckKeys(DynExpr::m_Functions);
+	fnCheckKeys(DynExpr::m_Constants);
+	fnCheckKeys(DynExpr::m_Variables);
+	fnCheckKeys(DynExpr::m_ClassMembers);
+
+	Test::Check(iLost == 0, std::format("{} bound names not found again", iLost));
+	Test::Check(iOperators > 0 && DynExpr::m_OpTrie.Find("*") != DynExpr::m_OpTrie.Find("**"), "operator trie");
+	Test::Check(DynExpr::m_OpTrie.Find("$") == DynExpr::symbol_pool_t::NPOS && DynExpr::m_Symbols.Find("NotAConstant") == DynExpr::symbol_pool_t::NPOS, "unknown names");
+
+	// A pool of its own, through a few rehashes.
+	DynExpr::symbol_pool_t Pool{};
+	vector<string> rgszNames{};
+
+	for (int i = 0; i < 1000; ++i)
+		rgszNames.emplace_back(std::format("name{}", i * 7919));
+
+	for (auto&& szName : rgszNames)
+		Pool.Intern(szName);
+
+	std::size_t iMisplaced{};
+
+	for (auto&& [id, szName] : rgszNames | std::views::enumerate)
+		iMisplaced += Pool.Find(szName) != (std::uint32_t)id || Pool.Intern(szName) != (std::uint32_t)id;
+
+	Test::Check(iMisplaced == 0 && Pool.m_Names.size() == rgszNames.size(), std::format("{} interned names misplaced", iMisplaced));
+	Test::Check(std::has_single_bit(Pool.m_Buckets.size()) && Pool.m_Buckets.size() >= Pool.m_Names.size() * 2, "bucket count a power of two, load under a half");
+}
+
+// Evaluations per second of what the pistols run on every studio event.
+static void Benchmark() noexcept
+{
+	static constexpr std::array<string_view, 4> EXPRESSIONS
+	{
+		"-min(MAXCLIP - CLIP, AMMO)",
+		"MAXCLIP - CLIP",
+		"clamp(AMMO - (MAXCLIP - CLIP), 0, AMMO)",
+		"vec3(25, -rand(85, 110), rand(85, 110))",
+	};
+	static constexpr int ROUNDS = 200'000;
+
+	for (auto&& szExpr : EXPRESSIONS)
+	{
+		auto const prog = DynExpr::Compile(szExpr);
+
+		if (!Test::Check(prog.has_value(), std::format("'{}' compiles", szExpr)))
+			continue;
+
+		std::size_t iFailed{};
+		auto const t = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < ROUNDS; ++i)
+			iFailed += !DynExpr::Execute<DynExpr::value_t>(*prog, FRAME).has_value();
+
+		auto const flSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+
+		Test::Check(iFailed == 0, std::format("'{}' evaluates", szExpr));
+		std::println("DynExpr, {}: {:.0f} evaluations per second.", szExpr, flSeconds > 0 ? ROUNDS / flSeconds : 0.0);
+	}
+}
+
+void TestDynExpr() noexcept
+{
+	InitializeDynExpr();
+
+	auto const rgszCorpus = ReadLines("DynExpr.corpus.txt");
+
+	TestGolden(rgszCorpus);
+	TestFolding();
+	TestBatch(rgszCorpus);
+	TestSymbols(rgszCorpus);
+	Benchmark();
+}
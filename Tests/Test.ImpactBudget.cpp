@@ -0,0 +1,210 @@
+import std;
+import hlsdk;
+
+import ImpactBudget;
+
+import Test;
+
+
+// Audio and cosmetic cost of the materials ImpactCost() knows, FireBullets.cpp.
+struct material_cost_t
+{
+	std::size_t m_iAudio{};
+	std::size_t m_iCosmetic{};
+};
+
+inline constexpr std::array MATERIALS
+{
+	material_cost_t{ SOUND_MSG_SIZE, BREAKMODEL_MSG_SIZE + ENTITY_SPAWN_SIZE },	// concrete
+	material_cost_t{ SOUND_MSG_SIZE * 2, ENTITY_SPAWN_SIZE + DLIGHT_MSG_SIZE + STREAK_MSG_SIZE },	// metal
+	material_cost_t{ SOUND_MSG_SIZE * 2, BREAKMODEL_MSG_SIZE + ENTITY_SPAWN_SIZE },	// wood
+	material_cost_t{ SOUND_MSG_SIZE * 2, SPRITETRAIL_MSG_SIZE + ENTITY_SPAWN_SIZE * 2 },	// snow
+	material_cost_t{ SOUND_MSG_SIZE, ENTITY_SPAWN_SIZE },	// anything else
+};
+
+// Bytes each client receives, routed the way VFX_BulletImpact() sends a planned impact:
+// tracers to their own clients, decals broadcasted, sounds and cosmetics to the clients near the impact.
+struct message_sink_t
+{
+	std::array<std::size_t, 32> m_rgiBytes{};
+
+	void Send(ImpactBudget::impact_t const& Impact, std::span<ImpactBudget::viewer_t const> Viewers) noexcept
+	{
+		for (auto bits = Impact.m_bitsTracer; bits; bits &= bits - 1)
+			m_rgiBytes[std::countr_zero(bits)] += TRACER_MSG_SIZE;
+
+		for (auto&& Viewer : Viewers)
+		{
+			auto& iBytes = m_rgiBytes[Viewer.m_iSlot];
+
+			if (Impact.m_bDecal)
+				iBytes += DECAL_MSG_SIZE;
+
+			if ((Impact.m_tr.vecEndPos - Viewer.m_vecEye).LengthSquared() >= ImpactBudget::RELEVANT_DIST * ImpactBudget::RELEVANT_DIST)
+				continue;
+
+			if (Impact.m_bAudio)
+				iBytes += Impact.m_iAudioCost;
+
+			if (Impact.m_bCosmetic)
+				iBytes += Impact.m_iCosmeticCost;
+		}
+	}
+};
+
+// Two teams of 16 trading fire across a 1800 units wide room for 10 seconds at 100 fps.
+// Rifles and SMGs may punch an exit hole, a quarter of the players fire 9 pellet shotguns.
+void TestImpactBudget() noexcept
+{
+	struct player_t
+	{
+		Vector m_vecOrigin{};
+		Vector m_vecForward{};
+		int m_iWeapon{};	// 0, 1: rifle, 2: SMG, 3: shotgun
+		float m_flNextAttack{};
+		int m_iTarget{};
+	};
+
+	std::mt19937 Gen{ 1234 };
+	std::uniform_real_distribution<float> Unit{ 0.f, 1.f };
+
+	std::array<player_t, 32> rgPlayers{};
+	std::array<edict_t, 8> rgWalls{};
+
+	for (int i = 0; i < 32; ++i)
+	{
+		auto const bTeamA = i < 16;
+
+		rgPlayers[i].m_vecOrigin = Vector{ bTeamA ? 300.f * Unit(Gen) : 1800.f + 300.f * Unit(Gen), 100.f * (i % 16), 64.f };
+		rgPlayers[i].m_iWeapon = i % 4;
+		rgPlayers[i].m_flNextAttack = Unit(Gen) * 0.2f;
+		rgPlayers[i].m_iTarget = bTeamA ? 16 + (i * 7) % 16 : (i * 5) % 16;
+	}
+
+	ImpactBudget::m_Stats = {};
+	ImpactBudget::m_Pending.clear();
+
+	std::vector<ImpactBudget::viewer_t> Viewers{};
+	std::vector<std::size_t> rgiClientFrames{};
+	std::size_t iOverBudget{}, iAccountingMismatches{}, iDecals{};
+
+	for (int iFrame = 0; iFrame < 1000; ++iFrame)
+	{
+		auto const flTime = (float)iFrame * 0.01f;
+
+		for (auto&& Player : rgPlayers)
+		{
+			auto const& Target = rgPlayers[Player.m_iTarget];
+			Player.m_vecForward = (Target.m_vecOrigin - Player.m_vecOrigin).Normalize();
+
+			if (flTime < Player.m_flNextAttack)
+				continue;
+
+			auto const iPellets = Player.m_iWeapon == 3 ? 9 : 1;
+			Player.m_flNextAttack = flTime + (Player.m_iWeapon == 3 ? 0.9f : Player.m_iWeapon == 2 ? 0.08f : 0.1f);
+
+			auto const pWall = &rgWalls[(std::size_t)(Unit(Gen) * rgWalls.size()) % rgWalls.size()];
+			auto const iMaterial = (std::size_t)(Unit(Gen) * MATERIALS.size()) % MATERIALS.size();
+			auto const vecAim = Target.m_vecOrigin + Vector{ -Player.m_vecForward.x * 24.f, (Unit(Gen) - .5f) * 64.f, (Unit(Gen) - .5f) * 48.f };
+
+			for (int iPellet = 0; iPellet < iPellets; ++iPellet)
+			{
+				auto const flSpread = iPellets > 1 ? 40.f : 0.f;
+
+				TraceResult tr{};
+				tr.vecEndPos = vecAim + Vector{ 0.f, (Unit(Gen) - .5f) * flSpread, (Unit(Gen) - .5f) * flSpread };
+				tr.vecPlaneNormal = -Player.m_vecForward;
+				tr.pHit = pWall;
+
+				ImpactBudget::Queue(Player.m_vecOrigin, tr, (char)iMaterial, 30.f, MATERIALS[iMaterial].m_iAudio, MATERIALS[iMaterial].m_iCosmetic);
+
+				// Exit hole.
+				if (Player.m_iWeapon < 2 && Unit(Gen) < 0.3f)
+				{
+					tr.vecEndPos = tr.vecEndPos + Player.m_vecForward * 16.f;
+					tr.vecPlaneNormal = Player.m_vecForward;
+
+					ImpactBudget::Queue(Player.m_vecOrigin, tr, (char)iMaterial, 30.f, MATERIALS[iMaterial].m_iAudio, MATERIALS[iMaterial].m_iCosmetic);
+				}
+			}
+		}
+
+		if (ImpactBudget::m_Pending.empty())
+			continue;
+
+		Viewers.clear();
+
+		for (auto&& [iSlot, Player] : rgPlayers | std::views::enumerate)
+			Viewers.emplace_back(ImpactBudget::viewer_t{ .m_vecEye{ Player.m_vecOrigin }, .m_vecForward{ Player.m_vecForward }, .m_iSlot{ (std::uint8_t)iSlot } });
+
+		ImpactBudget::Plan(Viewers);
+
+		message_sink_t Sink{};
+
+		for (auto&& Impact : ImpactBudget::m_Pending)
+		{
+			Sink.Send(Impact, Viewers);
+			iDecals += Impact.m_bDecal;
+		}
+
+		ImpactBudget::m_Pending.clear();
+
+		for (auto&& iBytes : Sink.m_rgiBytes)
+		{
+			rgiClientFrames.push_back(iBytes);
+			iOverBudget += iBytes > ImpactBudget::BYTES_PER_CLIENT_FRAME;
+		}
+
+		iAccountingMismatches += Sink.m_rgiBytes != ImpactBudget::m_Stats.m_rgiLastBytes;
+	}
+
+	Test::Check(!rgiClientFrames.empty(), "the firefight produced impacts");
+	Test::Check(iOverBudget == 0, std::format("{} client frames over {} bytes", iOverBudget, ImpactBudget::BYTES_PER_CLIENT_FRAME));
+	Test::Check(iAccountingMismatches == 0, std::format("{} frames where Plan() and the sink disagree on the bytes sent", iAccountingMismatches));
+	Test::Check(iDecals > 0, "some decals went out");
+
+	if (!rgiClientFrames.empty())
+	{
+		std::ranges::sort(rgiClientFrames);
+
+		auto const& Stats = ImpactBudget::m_Stats;
+		auto const fnPercentile = [&](std::size_t iPercent) noexcept { return rgiClientFrames[(rgiClientFrames.size() - 1) * iPercent / 100]; };
+
+		std::println("ImpactBudget, 32 players: bytes per client frame p50 {} p95 {} p99 {} max {}, budget {}.",
+			fnPercentile(50), fnPercentile(95), fnPercentile(99), rgiClientFrames.back(), ImpactBudget::BYTES_PER_CLIENT_FRAME);
+		std::println("ImpactBudget, 32 players: {} queued, {} merged, {} played; dropped {} decals, {} tracers, {} sounds, {} cosmetics.",
+			Stats.m_iQueued, Stats.m_iMerged, Stats.m_iPlanned,
+			Stats.m_iDecalsDropped, Stats.m_iTracersDropped, Stats.m_iAudioDropped, Stats.m_iCosmeticDropped);
+	}
+
+	// More distinct impacts in one frame than decals fit in the budget, e.g. a few shotguns emptied into a wall.
+	{
+		std::array<edict_t, 64> rgTargets{};
+		ImpactBudget::viewer_t const Viewer{ .m_vecEye{ 0.f, 0.f, 64.f }, .m_vecForward{ 1.f, 0.f, 0.f }, .m_iSlot{ 5 } };
+
+		ImpactBudget::m_Stats = {};
+
+		for (auto&& [i, Target] : rgTargets | std::views::enumerate)
+		{
+			TraceResult tr{};
+			tr.vecEndPos = Vector{ 256.f, (float)i * 32.f, 64.f };
+			tr.vecPlaneNormal = Vector{ -1.f, 0.f, 0.f };
+			tr.pHit = &Target;
+
+			ImpactBudget::Queue(Viewer.m_vecEye, tr, 0, 30.f, 0, 0);
+		}
+
+		ImpactBudget::Plan(std::span{ &Viewer, 1 });
+
+		message_sink_t Sink{};
+
+		for (auto&& Impact : ImpactBudget::m_Pending)
+			Sink.Send(Impact, std::span{ &Viewer, 1 });
+
+		ImpactBudget::m_Pending.clear();
+
+		Test::Check(rgTargets.size() * DECAL_MSG_SIZE > ImpactBudget::BYTES_PER_CLIENT_FRAME, "the burst must not fit");
+		Test::Check(Sink.m_rgiBytes[Viewer.m_iSlot] <= ImpactBudget::BYTES_PER_CLIENT_FRAME, std::format("burst sent {} bytes", Sink.m_rgiBytes[Viewer.m_iSlot]));
+		Test::Check(ImpactBudget::m_Stats.m_iDecalsDropped > 0, "decals past the budget are dropped");
+	}
+}
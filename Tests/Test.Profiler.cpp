@@ -0,0 +1,165 @@
+import std;
+
+import Profiler;
+
+import Test;
+
+
+using Profiler::histogram_t;
+
+// Bucket() and BucketFloor() must agree, and a bucket floor may be off by no more than 1/SUB_BUCKETS of the value.
+static void TestBuckets() noexcept
+{
+	for (auto const iValue : { 0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 17ull, 100ull, 1000ull, 123456ull, (1ull << 32) + 5, ~0ull })
+	{
+		auto const iBucket = histogram_t::Bucket(iValue);
+
+		if (!Test::Check(iBucket < Profiler::BUCKETS, std::format("{} lands past the last bucket", iValue)))
+			continue;
+
+		Test::Check(histogram_t::BucketFloor(iBucket) <= iValue, std::format("floor of the bucket of {} is above it", iValue));
+		Test::Check(iBucket + 1 == Profiler::BUCKETS || histogram_t::BucketFloor(iBucket + 1) > iValue, std::format("{} belongs to a later bucket", iValue));
+		Test::Check(histogram_t::Bucket(histogram_t::BucketFloor(iBucket)) == iBucket, std::format("floor of bucket {} lands elsewhere", iBucket));
+	}
+
+	std::size_t iUnordered{};
+
+	for (std::size_t i = 1; i < Profiler::BUCKETS; ++i)
+		iUnordered += histogram_t::BucketFloor(i) <= histogram_t::BucketFloor(i - 1);
+
+	Test::Check(iUnordered == 0, std::format("{} bucket floors not increasing", iUnordered));
+
+	std::mt19937_64 Gen{ 1 };
+	double flWorst{};
+
+	for (int i = 0; i < 1'000'000; ++i)
+	{
+		auto const iValue = Gen() >> (Gen() % 60);
+
+		if (iValue < Profiler::SUB_BUCKETS)
+			continue;
+
+		auto const iFloor = histogram_t::BucketFloor(histogram_t::Bucket(iValue));
+		flWorst = std::max(flWorst, (double)(iValue - iFloor) / (double)iValue);
+	}
+
+	Test::Check(flWorst <= 1.0 / Profiler::SUB_BUCKETS, std::format("bucket relative error {:.4f}", flWorst));
+}
+
+// Timings look roughly lognormal, compare against the exact nearest rank of the same samples.
+static void TestPercentiles() noexcept
+{
+	std::mt19937_64 Gen{ 2 };
+	std::lognormal_distribution<> LogNormal{ 9.0, 1.2 };
+
+	histogram_t Hist{};
+	std::vector<std::uint64_t> rgiValues{};
+
+	for (int i = 0; i < 200'000; ++i)
+	{
+		auto const iValue = (std::uint64_t)LogNormal(Gen);
+
+		rgiValues.push_back(iValue);
+		Hist.Add(iValue);
+	}
+
+	std::ranges::sort(rgiValues);
+
+	for (auto const flPercent : { 1.0, 10.0, 50.0, 90.0, 99.0, 99.9, 100.0 })
+	{
+		auto const iExact = rgiValues[(std::size_t)std::ceil(flPercent / 100.0 * (double)rgiValues.size()) - 1];
+		auto const iGot = Hist.Percentile(flPercent);
+
+		Test::Check(iGot <= iExact && iExact - iGot <= iExact / Profiler::SUB_BUCKETS + 1,
+			std::format("p{}: got {}, exact {}", flPercent, iGot, iExact));
+	}
+
+	auto const flMean = std::ranges::fold_left(rgiValues, 0.0, std::plus<>{}) / (double)rgiValues.size();
+
+	Test::Check(Hist.m_iCount == rgiValues.size(), "sample count");
+	Test::Check(Hist.Percentile(100) <= Hist.m_iMax && Hist.m_iMax == rgiValues.back(), "nothing reported beyond the largest sample");
+	Test::Check(std::abs(Hist.Mean() - flMean) < 1e-6 * flMean, std::format("mean {} against {}", Hist.Mean(), flMean));
+
+	histogram_t Empty{};
+	Test::Check(Empty.Percentile(50) == 0 && Empty.Mean() == 0, "empty histogram");
+
+	histogram_t One{};
+	One.Add(5);
+	Test::Check(One.Percentile(0.1) == 5 && One.Percentile(100) == 5, "single sample");
+
+	// Small values have a bucket each, so the nearest rank comes out exact.
+	histogram_t Small{};
+
+	for (std::uint64_t i = 1; i <= Profiler::SUB_BUCKETS; ++i)
+		Small.Add(i);
+
+	Test::Check(Small.Percentile(50) == Profiler::SUB_BUCKETS / 2 && Small.Percentile(51) == Profiler::SUB_BUCKETS / 2 + 1,
+		std::format("nearest rank of 1..{}: p50 {}, p51 {}", Profiler::SUB_BUCKETS, Small.Percentile(50), Small.Percentile(51)));
+}
+
+// Traces and messages only count inside a shot, nested shots keep their own counts. Timed types, so this runs in release too.
+static void TestShots() noexcept
+{
+	Profiler::Reset();
+
+	auto const iA = Profiler::ClassIndex("test_shot_a");
+	auto const iB = Profiler::ClassIndex("test_shot_b");
+
+	Test::Check(Profiler::ClassIndex("test_shot_a") == iA && iA != iB, "class indices");
+
+	Profiler::OnTraceLine();	// Outside of any shot.
+
+	for (int i = 0; i < 100; ++i)
+	{
+		Profiler::timed_shot_t Shot{ iA };
+
+		for (int j = 0; j < 3; ++j)
+			Profiler::OnTraceLine();
+
+		Profiler::OnMessageBegin();
+
+		{
+			Profiler::timed_shot_t Inner{ iB };
+
+			Profiler::OnTraceLine();
+			Profiler::OnMessageBegin();
+			Profiler::OnMessageBegin();
+		}
+
+		Profiler::OnTraceLine();
+
+		Profiler::timed_scope_t Scope{ Profiler::STAGE_FIRE_BULLETS, iA };
+	}
+
+	Profiler::Flush();
+
+	auto const& A = Profiler::m_Records[iA];
+	auto const& B = Profiler::m_Records[iB];
+
+	Test::Check(A.m_Stages[Profiler::STAGE_SHOT].m_iCount == 100 && A.m_Stages[Profiler::STAGE_FIRE_BULLETS].m_iCount == 100, "shot and scope samples");
+	Test::Check(A.m_Traces.m_iMax == 4 && A.m_Traces.Percentile(50) == 4, std::format("outer shot traces, max {}", A.m_Traces.m_iMax));
+	Test::Check(A.m_Messages.m_iMax == 1, std::format("outer shot messages, max {}", A.m_Messages.m_iMax));
+	Test::Check(B.m_Traces.Mean() == 1 && B.m_Messages.Mean() == 2, "inner shot counts");
+	Test::Check(!Profiler::m_Ring.m_bInShot, "no shot left open");
+
+	// A full ring counts what it drops instead of writing past the end.
+	for (std::size_t i = 0; i < Profiler::RING_SIZE + 10; ++i)
+		Profiler::timed_scope_t Scope{ Profiler::STAGE_EFFECTS, iB };
+
+	Test::Check(Profiler::m_Ring.m_iCount == Profiler::RING_SIZE && Profiler::m_Ring.m_iDropped == 10, "ring overflow");
+
+	Profiler::Flush();
+
+	Test::Check(Profiler::m_iDropped == 10 && B.m_Stages[Profiler::STAGE_EFFECTS].m_iCount == Profiler::RING_SIZE, "dropped samples carried into the records");
+
+	Profiler::Reset();
+
+	Test::Check(A.m_Stages[Profiler::STAGE_SHOT].m_iCount == 0 && Profiler::m_iDropped == 0, "reset");
+}
+
+void TestProfiler() noexcept
+{
+	TestBuckets();
+	TestPercentiles();
+	TestShots();
+}
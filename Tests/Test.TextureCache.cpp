@@ -0,0 +1,304 @@
+#include <string.h>
+
+import std;
+import hlsdk;
+
+import TextureCache;
+
+import Test;
+
+
+// HLSDK dlls/sound.cpp and util.cpp, reading from a string instead of the engine file system.
+namespace Reference
+{
+	inline constexpr int CBTEXTURENAMEMAX = 13;
+	inline constexpr int CTEXTURESMAX = 512;
+
+	int gcTextures = 0;
+	char grgszTextureName[CTEXTURESMAX][CBTEXTURENAMEMAX];
+	char grgchTextureType[CTEXTURESMAX];
+
+	char* memfgets(char const* pMemFile, int fileSize, int& filePos, char* pBuffer, int bufferSize) noexcept
+	{
+		if (filePos >= fileSize)
+			return nullptr;
+
+		int i = filePos;
+		int last = fileSize;
+
+		// fgets always NULL terminates, so only read bufferSize-1 characters
+		if (last - filePos > (bufferSize - 1))
+			last = filePos + (bufferSize - 1);
+
+		int stop = 0;
+
+		// Stop at the next newline (inclusive) or end of buffer
+		while (i < last && !stop)
+		{
+			if (pMemFile[i] == '\n')
+				stop = 1;
+			i++;
+		}
+
+		if (i != filePos)
+		{
+			int size = i - filePos;
+			std::memcpy(pBuffer, pMemFile + filePos, size);
+
+			if (size < bufferSize)
+				pBuffer[size] = 0;
+
+			filePos = i;
+			return pBuffer;
+		}
+
+		return nullptr;
+	}
+
+	void TEXTURETYPE_Init(std::string_view szFile) noexcept
+	{
+		char buffer[512];
+		int i, j;
+		int filePos = 0;
+
+		gcTextures = 0;
+		std::memset(grgszTextureName, 0, sizeof(grgszTextureName));
+		std::memset(grgchTextureType, 0, sizeof(grgchTextureType));
+
+		while (memfgets(szFile.data(), (int)szFile.size(), filePos, buffer, sizeof(buffer) - 1) && (gcTextures < CTEXTURESMAX))
+		{
+			// skip whitespace
+			i = 0;
+			while (buffer[i] && std::isspace((unsigned char)buffer[i]))
+				i++;
+
+			if (!buffer[i])
+				continue;
+
+			// skip comment lines
+			if (buffer[i] == '/' || !std::isalpha((unsigned char)buffer[i]))
+				continue;
+
+			// get texture type
+			grgchTextureType[gcTextures] = (char)std::toupper((unsigned char)buffer[i++]);
+
+			// skip whitespace
+			while (buffer[i] && std::isspace((unsigned char)buffer[i]))
+				i++;
+
+			if (!buffer[i])
+				continue;
+
+			// get sentence name
+			j = i;
+			while (buffer[j] && !std::isspace((unsigned char)buffer[j]))
+				j++;
+
+			if (!buffer[j])
+				continue;
+
+			// null-terminate name and save in sentences array
+			j = std::min(j, CBTEXTURENAMEMAX - 1 + i);
+			buffer[j] = 0;
+			std::strcpy(&(grgszTextureName[gcTextures++][0]), &(buffer[i]));
+		}
+	}
+
+	char TEXTURETYPE_Find(char const* name) noexcept
+	{
+		for (int i = 0; i < gcTextures; i++)
+		{
+			if (!_strnicmp(name, &(grgszTextureName[i][0]), CBTEXTURENAMEMAX - 1))
+				return grgchTextureType[i];
+		}
+
+		return CHAR_TEX_CONCRETE;
+	}
+
+	// The name handling of UTIL_TextureHit(), after TRACE_TEXTURE() returned pTextureName.
+	char TextureHit(char const* pTextureName) noexcept
+	{
+		char szbuffer[64];
+
+		if (*pTextureName == '-' || *pTextureName == '+')
+			pTextureName += 2;
+
+		if (*pTextureName == '{' || *pTextureName == '!' || *pTextureName == '~' || *pTextureName == ' ')
+			pTextureName++;
+
+		std::strcpy(szbuffer, pTextureName);
+		szbuffer[CBTEXTURENAMEMAX - 1] = 0;
+
+		return TEXTURETYPE_Find(szbuffer);
+	}
+}
+
+// Everything TEXTURETYPE_Init() has an opinion about: comments, stray characters, names at the 12 character cut,
+// duplicates, lines longer than its buffer and more entries than it keeps.
+[[nodiscard]] static auto GenerateTable(std::mt19937& Gen, std::vector<std::string>* prgszNames) noexcept -> std::string
+{
+	static constexpr std::string_view ALPHABET = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-{}!~";
+	static constexpr std::string_view TYPES = "CMDVGTSWPYNFcmdx";
+	static constexpr std::array<std::string_view, 6> SPACES{ " ", "\t", "  ", " \t ", "\r", "\v" };
+
+	auto const fnRand = [&](std::size_t n) noexcept { return std::uniform_int_distribution<std::size_t>{ 0, n - 1 }(Gen); };
+	auto const fnName = [&]() noexcept
+	{
+		std::string ret{};
+
+		for (auto i = 2 + fnRand(18); i; --i)
+			ret += ALPHABET[fnRand(ALPHABET.size())];
+
+		return ret;
+	};
+
+	std::string szFile{};
+
+	for (int iLine = 0; iLine < 900; ++iLine)
+	{
+		auto szName = (!prgszNames->empty() && fnRand(6) == 0) ? (*prgszNames)[fnRand(prgszNames->size())] : fnName();
+
+		// Same first 12 characters, different tail.
+		if (!prgszNames->empty() && fnRand(10) == 0 && (*prgszNames)[0].size() >= 12)
+			szName = (*prgszNames)[0].substr(0, 12) + fnName();
+
+		for (auto&& c : szName)
+		{
+			if (fnRand(3) == 0)
+				c = (char)std::toupper((unsigned char)c);
+		}
+
+		prgszNames->emplace_back(szName);
+
+		std::string szLine{ SPACES[fnRand(SPACES.size())].substr(0, fnRand(2) ? 0 : 4) };
+
+		switch (fnRand(12))
+		{
+		case 0:
+			szLine += "// ";
+			break;
+
+		case 1:
+			szLine += std::to_string(fnRand(10));	// Not led by a letter.
+			break;
+
+		case 2:
+			szLine += TYPES[fnRand(TYPES.size())];	// Type without a name.
+			szFile += szLine + "\n";
+			continue;
+
+		case 3:
+			szLine += std::string(500 + fnRand(30), ' ');	// Past the 510 characters memfgets() hands out.
+			break;
+
+		default:
+			break;
+		}
+
+		szLine += TYPES[fnRand(TYPES.size())];
+		szLine += SPACES[fnRand(SPACES.size())];
+		szLine += szName;
+
+		if (fnRand(8) == 0)
+			szLine += std::string(SPACES[fnRand(SPACES.size())]) + fnName();
+
+		szFile += szLine;
+		szFile += fnRand(10) ? "\n" : "\r\n";
+	}
+
+	return szFile;
+}
+
+void TestTextureCache() noexcept
+{
+	static constexpr std::array<std::string_view, 9> PREFIXES{ "", "-0", "+a", "+A", "{", "!", "~", " ", "-1{" };
+
+	for (auto const iSeed : { 1u, 2u, 3u, 20250101u })
+	{
+		std::mt19937 Gen{ iSeed };
+		std::vector<std::string> rgszNames{};
+
+		auto const szFile = GenerateTable(Gen, &rgszNames);
+
+		Reference::TEXTURETYPE_Init(szFile);
+
+		TextureCache::m_Types.clear();
+		TextureCache::m_Surfaces.clear();
+
+		auto const f = std::tmpfile();
+		if (!Test::Check(f != nullptr, "tmpfile"))
+			return;
+
+		std::fwrite(szFile.data(), 1, szFile.size(), f);
+		std::rewind(f);
+		TextureCache::Parse(f);
+		std::fclose(f);
+
+		Test::Check(Reference::gcTextures == Reference::CTEXTURESMAX, "the table must overflow CTEXTURESMAX to test the limit");
+		Test::Check(TextureCache::m_Stats.m_iTypes == (std::size_t)Reference::gcTextures, "entry count");
+
+		std::size_t iMismatches{};
+		auto const fnCompare = [&](std::string const& szTexture) noexcept
+		{
+			auto const cExpected = Reference::TextureHit(szTexture.c_str());
+			auto const cGot = TextureCache::Find(szTexture);
+
+			if (cExpected != cGot && ++iMismatches <= 10)
+				Test::Check(false, std::format("seed {}, '{}': expected '{}', got '{}'", iSeed, szTexture, cExpected, cGot));
+		};
+
+		// Every name the generator wrote, plus a few it never did, with the prefixes and case of map textures.
+		for (auto&& szName : rgszNames)
+		{
+			for (auto&& szPrefix : PREFIXES)
+			{
+				auto szTexture = std::string{ szPrefix } + szName;
+				fnCompare(szTexture);
+
+				for (auto&& c : szTexture)
+					c = (char)std::toupper((unsigned char)c);
+
+				fnCompare(szTexture);
+			}
+
+			fnCompare(szName + "x");
+
+			if (szName.size() > 2)
+				fnCompare(szName.substr(0, szName.size() - 1));
+		}
+
+		Test::Check(iMismatches == 0, std::format("seed {}: {} mismatches against TEXTURETYPE_Find()", iSeed, iMismatches));
+	}
+
+	// The random tables never get to their last line.
+	static constexpr std::string_view SMALL_TABLE =
+		"// comment\n"
+		"C concrete1\n"
+		"M Metal_Long_Name_Cut\n"
+		"m metal_long_nXX\n"
+		"1 digits\n"
+		"W\n"
+		"G lastline";
+
+	Reference::TEXTURETYPE_Init(SMALL_TABLE);
+
+	TextureCache::m_Types.clear();
+	TextureCache::m_Surfaces.clear();
+
+	if (auto const f = std::tmpfile(); Test::Check(f != nullptr, "tmpfile"))
+	{
+		std::fwrite(SMALL_TABLE.data(), 1, SMALL_TABLE.size(), f);
+		std::rewind(f);
+		TextureCache::Parse(f);
+		std::fclose(f);
+	}
+
+	Test::Check(TextureCache::m_Stats.m_iTypes == 3 && Reference::gcTextures == 3, "small table entry count");
+
+	for (auto&& szTexture : { "concrete1", "{METAL_LONG_NAME", "metal_long_nzz", "digits", "lastline", "definitelynotatexture" })
+		Test::Check(TextureCache::Find(szTexture) == Reference::TextureHit(szTexture), std::format("small table, '{}'", szTexture));
+
+	Test::Check(TextureCache::Find("METAL_LONG_NAME") == 'M', "names are cut at 12 characters and the first entry wins");
+	Test::Check(TextureCache::Find("lastline") == CHAR_TEX_CONCRETE, "a last line without line break is dropped");
+	Test::Check(TextureCache::Find("definitelynotatexture") == CHAR_TEX_CONCRETE, "a miss falls back to concrete");
+}
@@ -0,0 +1,44 @@
+export module Test;
+
+import std;
+
+
+
+export namespace Test
+{
+	inline std::size_t m_iChecks{};
+	inline std::size_t m_iFailures{};
+
+	// Keeps going after a failure, main() reports the count.
+	bool Check(bool bPassed, std::string_view szWhat, std::source_location const& Loc = std::source_location::current()) noexcept
+	{
+		++m_iChecks;
+
+		if (!bPassed)
+		{
+			++m_iFailures;
+			std::println(stderr, "{}({}): {}", Loc.file_name(), Loc.line(), szWhat);
+		}
+
+		return bPassed;
+	}
+
+	template <typename L, typename R, typename... Args>
+	R Thunk(Args... args) noexcept
+	{
+		return L{}(args...);
+	}
+
+	// Point an engine function at a captureless lambda, whatever exact parameter types the SDK declares for it.
+	template <typename L, typename R, typename... Args>
+	void Install(R(*&pfn)(Args...), L) noexcept
+	{
+		pfn = &Thunk<L, R, Args...>;
+	}
+
+	template <typename L, typename R, typename... Args>
+	void Install(R(*&pfn)(Args...) noexcept, L) noexcept
+	{
+		pfn = &Thunk<L, R, Args...>;
+	}
+}
@@ -31,6 +31,7 @@ import ZBot;
 import Ammo;
 import BPW;
 import Buy;
+import Profiler;
 import WpnIdAllocator;
 
 using std::array;
@@ -82,13 +83,13 @@ enum EExtendedQcEvents : int32_t
 	EQCEV_DT_CLIP = 6101,
 };
 
-extern void UpdateGunSmokeList(std::string_view szSmokeNameRoot) noexcept;
-extern edict_t* CreateGunSmoke(CBasePlayer* pPlayer, Vector const& vecMuzzleOfs, std::string_view szSmokeNameRoot, int iPlayerAttIdx) noexcept;
+extern std::uint16_t UpdateGunSmokeList(std::string_view szSmokeNameRoot) noexcept;
+extern edict_t* CreateGunSmoke(CBasePlayer* pPlayer, Vector const& vecMuzzleOfs, std::uint16_t iSmokeList, int iPlayerAttIdx) noexcept;
 
 extern Vector2D CS_FireBullets3(
 	CBasePlayer* pAttacker, CBasePlayerItem* pInflictor,
 	Vector const& vecSrcOfs, float flSpread, float flDistance,
-	int iPenetration, CAmmoInfo const* pAmmoInfo, float flDamage, float flRangeModifier) noexcept;
+	int iPenetration, CAmmoInfo const* pAmmoInfo, float flDamage, float flRangeModifier, int iPellets) noexcept;
 
 [[nodiscard]] static auto GetAnimsFromKeywords(
 	string_view szModel, span<string_view const> rgszKeywords,
@@ -179,10 +180,65 @@ extern Vector2D CS_FireBullets3(
 	return rgszSoundPaths;
 }
 
-extern auto RunDynExpr(string_view szExpr) noexcept -> std::expected<std::any, string>;
+namespace DynExpr { struct Program; }
+extern auto CompileDynExpr(string_view szExpr) noexcept -> std::expected<DynExpr::Program const*, string>;
+template <typename T> auto ExecuteDynExpr(DynExpr::Program const* pProg, span<double const> Frame) noexcept -> std::expected<T, string>;
 extern void DynExprBindVector(string_view name, Vector const& vec) noexcept;
-extern void DynExprBindNum(string_view name, double num) noexcept;
-extern void DynExprUnbind(string_view name) noexcept;
+
+// Options of a QC event, split and compiled once per map when the view model is precached.
+struct qc_event_t final
+{
+	vector<string_view> m_Options{};
+	vector<DynExpr::Program const*> m_Scripts{};	// Parallel to m_Options. nullptr if the option is not a script or failed to compile.
+	std::uint16_t m_iSmokeList{};	// EQCEV_EF_MUZZLE_SMOKE only, from UpdateGunSmokeList().
+};
+
+struct qc_stats_t final
+{
+	std::size_t m_iCompiled{};
+	std::size_t m_iHits{};
+	std::size_t m_iFailures{};
+};
+
+// Keyed by the event inside the studio transcription, which lives until the map ends.
+static std::map<mstudioevent_t const*, qc_event_t> gQcEvents{};
+static std::map<string_view, qc_stats_t, sv_iless_t> gQcStats{};
+
+// Which options of an event are expressions.
+[[nodiscard]] static constexpr auto GetQcScriptSlots(int iEvent, std::size_t iOptionCount) noexcept -> span<std::size_t const>
+{
+	static constexpr std::size_t SECOND[] = { 1 };
+	static constexpr std::size_t THIRD[] = { 2 };
+	static constexpr std::size_t FIRST_TWO[] = { 0, 1 };
+
+	switch (iEvent)
+	{
+	case EQCEV_EF_EJECT_SHELL:	return span<std::size_t const>{ SECOND }.first(iOptionCount >= 2 ? 1 : 0);
+	case EQCEV_EF_MUZZLE_LIGHT:	return span<std::size_t const>{ THIRD }.first(iOptionCount >= 3 ? 1 : 0);
+	case EQCEV_DT_CLIP:			return span<std::size_t const>{ FIRST_TWO }.first(std::min<std::size_t>(iOptionCount, 2));
+	default:					return {};
+	}
+}
+
+void ClearQcEventCache() noexcept
+{
+#ifdef _DEBUG
+	for (auto&& [szModel, Stats] : gQcStats)
+	{
+		g_engfuncs.pfnServerPrint(
+			std::format("[WSIV] QC Scripts - {}: {} compiled, {} failed, {} hits\n",
+				szModel, Stats.m_iCompiled, Stats.m_iFailures, Stats.m_iHits
+			).c_str()
+		);
+	}
+#endif
+
+	gQcEvents.clear();
+
+	// Entries stay, weapon classes hold references to theirs.
+	for (auto&& Stats : gQcStats | std::views::values)
+		Stats = {};
+}
 
 template <typename CWeapon, typename AnimDat>
 struct CAnimationGroup final
@@ -287,7 +343,14 @@ struct CBasePistol : CPrefabWeapon
 		if (!m_pPlayer)
 			m_Scheduler.Think();
 	}
-	void ItemPostFrame() noexcept final { if (m_pPlayer) m_Scheduler.Think(); }
+	void ItemPostFrame() noexcept final
+	{
+		if (m_pPlayer)
+		{
+			Profiler::scope_t Scope{ Profiler::STAGE_ITEM_POST_FRAME, ProfilerClass() };
+			m_Scheduler.Think();
+		}
+	}
 
 	void Spawn() noexcept override
 	{
@@ -386,21 +449,31 @@ struct CBasePistol : CPrefabWeapon
 				{
 				case EQCEV_EF_MUZZLE_SMOKE:
 				{
-					auto const QcScript = CRTP()->ParseQcScript(&Event, &Sequence);
-					if (QcScript && QcScript->size() >= 3)
-						::UpdateGunSmokeList(QcScript->at(2));
+					auto const pQcEvent = GetQcEvent(&Event, &Sequence);
+					if (pQcEvent && pQcEvent->m_Options.size() >= 3)
+					{
+						QueueAttachmentOffset(T::MODEL_V, UTIL_StrToNum<unsigned>(pQcEvent->m_Options[0]), Sequence.m_index, (float)Event.frame);
+					}
 					break;
 				}
 				case EQCEV_EF_EJECT_SHELL:
 				{
-					auto const QcScript = CRTP()->ParseQcScript(&Event, &Sequence);
-					if (QcScript && QcScript->size() >= 3)
+					auto const pQcEvent = GetQcEvent(&Event, &Sequence);
+					if (pQcEvent && pQcEvent->m_Options.size() >= 3)
 					{
-						auto&& [it, bNew] = m_rgszReferencedShellModels.emplace(std::format("models/{}", QcScript->at(2)));
+						auto&& [it, bNew] = m_rgszReferencedShellModels.emplace(std::format("models/{}", pQcEvent->m_Options[2]));
 						Resource::Precache(*it);
+						QueueAttachmentOffset(T::MODEL_V, UTIL_StrToNum<unsigned>(pQcEvent->m_Options[0]), Sequence.m_index, (float)Event.frame);
 					}
 					break;
 				}
+				case EQCEV_EF_MUZZLE_LIGHT:
+				case EQCEV_DT_CLIP:
+				{
+					// Compile ahead, so nothing is parsed when the event fires.
+					GetQcEvent(&Event, &Sequence);
+					break;
+				}
 				case STUDIOEV_PLAYSOUND:
 				{
 					Resource::Precache(Event.options);
@@ -905,6 +978,9 @@ struct CBasePistol : CPrefabWeapon
 
 		--m_iClip;
 
+		// Dry fire above is not worth a sample.
+		Profiler::shot_t Shot{ ProfilerClass() };
+
 		[[maybe_unused]] bool const bShootingLeft{ !!(m_iWeaponState & WPNSTATE_ELITE_LEFT) };
 		if constexpr (requires { T::FLAG_DUAL_WIELDING; })
 		{
@@ -924,22 +1000,29 @@ struct CBasePistol : CPrefabWeapon
 		auto const [vecFwd, vecRight, vecUp]
 			= (m_pPlayer->pev->v_angle + m_pPlayer->pev->punchangle).AngleVectors();
 
-		if constexpr (requires { T::FLAG_DUAL_WIELDING; })
-		{
-			CS_FireBullets3(
-				m_pPlayer, this,
-				bShootingLeft ? (vecRight * -5) : (vecRight * 5),
-				CRTP()->EXPR_SPREAD(), CRTP()->DAT_EFF_SHOT_DIST, CRTP()->DAT_PENETRATION,
-				CRTP()->DAT_AMMUNITION, CRTP()->EXPR_DAMAGE(), CRTP()->DAT_RANGE_MODIFIER
-			);
-		}
-		else
+		// Shotgun-like weapons define DAT_PELLETS and fire them all in one call.
+		static constexpr int iPellets = [] { if constexpr (requires { T::DAT_PELLETS; }) return (int)T::DAT_PELLETS; else return 1; }();
+
 		{
-			CS_FireBullets3(
-				m_pPlayer, this,
-				g_vecZero, CRTP()->EXPR_SPREAD(), CRTP()->DAT_EFF_SHOT_DIST, CRTP()->DAT_PENETRATION,
-				CRTP()->DAT_AMMUNITION, CRTP()->EXPR_DAMAGE(), CRTP()->DAT_RANGE_MODIFIER
-			);
+			Profiler::scope_t Scope{ Profiler::STAGE_FIRE_BULLETS, ProfilerClass() };
+
+			if constexpr (requires { T::FLAG_DUAL_WIELDING; })
+			{
+				CS_FireBullets3(
+					m_pPlayer, this,
+					bShootingLeft ? (vecRight * -5) : (vecRight * 5),
+					CRTP()->EXPR_SPREAD(), CRTP()->DAT_EFF_SHOT_DIST, CRTP()->DAT_PENETRATION,
+					CRTP()->DAT_AMMUNITION, CRTP()->EXPR_DAMAGE(), CRTP()->DAT_RANGE_MODIFIER, iPellets
+				);
+			}
+			else
+			{
+				CS_FireBullets3(
+					m_pPlayer, this,
+					g_vecZero, CRTP()->EXPR_SPREAD(), CRTP()->DAT_EFF_SHOT_DIST, CRTP()->DAT_PENETRATION,
+					CRTP()->DAT_AMMUNITION, CRTP()->EXPR_DAMAGE(), CRTP()->DAT_RANGE_MODIFIER, iPellets
+				);
+			}
 		}
 
 		// LUNA:
@@ -1648,33 +1731,112 @@ public:
 		return true;
 	}
 
-	auto ParseQcScript(mstudioevent_t const* pEvent, TranscriptedSequence const* pAnim) const noexcept -> std::expected<std::vector<std::string_view>, std::string_view>
+	[[nodiscard]] static auto QcStats() noexcept -> qc_stats_t&
+	{
+		static auto& Stats = gQcStats[T::MODEL_V];
+		return Stats;
+	}
+
+	[[nodiscard]] static auto ProfilerClass() noexcept -> std::uint16_t
 	{
-		auto EvOption = UTIL_SplitByBrackets(pEvent->options)
-			.or_else([&](string_view s) noexcept -> std::expected<std::vector<std::string_view>, std::string_view> {
+		static auto const iClass = Profiler::ClassIndex(T::CLASSNAME);
+		return iClass;
+	}
+
+	// Split the options and compile the scripts among them on first sight. Errors are reported only then.
+	static auto GetQcEvent(mstudioevent_t const* pEvent, TranscriptedSequence const* pAnim) noexcept -> qc_event_t const*
+	{
+		auto&& [it, bNew] = gQcEvents.try_emplace(pEvent);
+		auto& QcEvent = it->second;
+
+		if (!bNew)
+			return QcEvent.m_Options.empty() ? nullptr : &QcEvent;
+
+		auto EvOption = UTIL_SplitByBrackets(pEvent->options);
+		if (!EvOption || EvOption->empty())
+		{
+			if (!EvOption)
+			{
 				g_engfuncs.pfnServerPrint(
 					std::format("[WSIV] QC Script Err - {}: {}: {}\n",
-						STRING(m_pPlayer->pev->viewmodel), pAnim->m_szLabel , s
+						T::MODEL_V, pAnim->m_szLabel, EvOption.error()
 					).c_str()
 				);
-				return std::unexpected(std::move(s));
-			});
+			}
+
+			return nullptr;
+		}
+
+		QcEvent.m_Options = std::move(*EvOption);
+		auto& Options = QcEvent.m_Options;
+
+		// Handle default val.
+		switch (pEvent->event)
+		{
+		case EQCEV_EF_EJECT_SHELL:
+			if (Options.size() >= 2 && sv_icmp_t{}(Options[1], "default"))
+				Options[1] = "vec3(25, -rand(85, 110), rand(85, 110))";
+			break;
+
+		case EQCEV_EF_MUZZLE_LIGHT:
+			if (Options.size() == 2 && sv_icmp_t{}(Options[1], "default"))
+			{
+				// UTIL_DLight(vecGunOrigin, 4.5f, { 255, 150, 15 }, 0.8f, 15.f);
+				Options[1] = "4.5";
+				Options.push_back("vec3(255, 150, 15)");
+				Options.push_back("0.8");
+				Options.push_back("15");
+			}
+			break;
+
+		case EQCEV_DT_CLIP:
+			if (Options.size() == 1 && sv_icmp_t{}(Options[0], "default"))
+				Options[0] = "-min(MAXCLIP - CLIP, AMMO)";
+			break;
+
+		default:
+			break;
+		}
+
+		// Sprites are looked up while precaching, the shots only index them.
+		if (pEvent->event == EQCEV_EF_MUZZLE_SMOKE && Options.size() >= 3)
+			QcEvent.m_iSmokeList = ::UpdateGunSmokeList(Options[2]);
 
-		return std::move(EvOption);
+		QcEvent.m_Scripts.assign(Options.size(), nullptr);
+
+		for (auto&& i : GetQcScriptSlots(pEvent->event, Options.size()))
+		{
+			if (auto const pScript = CompileDynExpr(Options[i]); pScript)
+			{
+				QcEvent.m_Scripts[i] = *pScript;
+				++QcStats().m_iCompiled;
+			}
+			else
+			{
+				g_engfuncs.pfnServerPrint(
+					std::format("[WSIV] QC Script Err - {}: {}: {}\n",
+						T::MODEL_V, pAnim->m_szLabel, pScript.error()
+					).c_str()
+				);
+				++QcStats().m_iFailures;
+			}
+		}
+
+		return &QcEvent;
 	}
 
 	template <typename R>
-	auto ExecuteQcScript(std::string_view szScript, TranscriptedSequence const* pAnim) const noexcept -> std::expected<R, std::string>
+	auto ExecuteQcScript(qc_event_t const& QcEvent, std::size_t iOption, TranscriptedSequence const* pAnim, span<double const> Frame = {}) const noexcept -> std::expected<R, std::string>
 	{
-		return RunDynExpr(szScript)
-			.and_then([&](std::any a) noexcept -> std::expected<R, std::string> {
-				try {
-					return std::any_cast<R>(std::move(a));
-				}
-				catch (const std::exception& e) {
-					return std::unexpected(e.what());
-				}
-			})
+		// Compile error had been reported at precache.
+		if (!QcEvent.m_Scripts[iOption])
+			return std::unexpected("Script failed to compile"s);
+
+		++QcStats().m_iHits;
+
+		Profiler::scope_t Scope{ Profiler::STAGE_QC_SCRIPT, ProfilerClass() };
+
+		return ExecuteDynExpr<R>(QcEvent.m_Scripts[iOption], Frame)
 			.or_else([&](string s) noexcept -> std::expected<R, std::string> {
 				g_engfuncs.pfnServerPrint(
 					std::format("[WSIV] QC Script Err - {}: {}: {}\n",
@@ -1687,6 +1849,8 @@ public:
 
 	void DispatchQcEvents(TranscriptedSequence const* pAnim) noexcept
 	{
+		Profiler::scope_t Scope{ Profiler::STAGE_QC_EVENTS, ProfilerClass() };
+
 		for (auto&& Event : pAnim->m_Events)
 		{
 			switch (Event.event)
@@ -1704,14 +1868,14 @@ public:
 							co_return;
 
 						// Expecting format: [VIEW_MODEL_ATTACHMENT] [PLAYER_MODEL_ATTACHMENT] [SPRITE_CANDIDATES]
-						auto const EvOption = pWeapon->ParseQcScript(pEvent, pAnim);
+						auto const pQcEvent = pWeapon->GetQcEvent(pEvent, pAnim);
 
-						if (!EvOption || EvOption->size() < 3)
+						if (!pQcEvent || pQcEvent->m_Options.size() < 3)
 							co_return;
 
-						auto const iViewModelAtt = UTIL_StrToNum<unsigned>(EvOption->at(0));
-						auto const iPlayerAtt = UTIL_StrToNum<int>(EvOption->at(1));
-						auto const& szGunSmoke = EvOption->at(2);
+						auto const& EvOption = pQcEvent->m_Options;
+						auto const iViewModelAtt = UTIL_StrToNum<unsigned>(EvOption[0]);
+						auto const iPlayerAtt = UTIL_StrToNum<int>(EvOption[1]);
 						auto const vecMuzOfs = UTIL_GetAttachmentOffset(
 							STRING(pPlayer->pev->viewmodel),
 							iViewModelAtt,
@@ -1719,7 +1883,7 @@ public:
 							(float)pEvent->frame
 						);
 
-						CreateGunSmoke(pPlayer, vecMuzOfs, szGunSmoke, iPlayerAtt);
+						CreateGunSmoke(pPlayer, vecMuzOfs, pQcEvent->m_iSmokeList, iPlayerAtt);
 
 					}(this, m_pPlayer, &Event, pAnim),
 					TASK_EQCEV_EF_MUZZLE_SMOKE
@@ -1739,20 +1903,17 @@ public:
 							co_return;
 
 						// Expecting format: [ATTACHMENT_NUM] [vec3(FWD, RIGHT, UP)] [MODEL] [SOUND]
-						auto EvOption = pWeapon->ParseQcScript(pEvent, pAnim);
+						auto const pQcEvent = pWeapon->GetQcEvent(pEvent, pAnim);
 
-						if (!EvOption || EvOption->size() < 4)
+						if (!pQcEvent || pQcEvent->m_Options.size() < 4)
 							co_return;
 
-						// Handle default val
-						if (sv_icmp_t{}(EvOption->at(1), "default"))
-							EvOption->at(1) = "vec3(25, -rand(85, 110), rand(85, 110))";
-
-						auto const QcVeclocity = pWeapon->ExecuteQcScript<Vector>(EvOption->at(1), pAnim);
+						auto const& EvOption = pQcEvent->m_Options;
+						auto const QcVeclocity = pWeapon->ExecuteQcScript<Vector>(*pQcEvent, 1, pAnim);
 						if (!QcVeclocity)
 							co_return;
 
-						auto const iAttachment = UTIL_StrToNum<unsigned>(EvOption->at(0));	// arg0: attachment idx.
+						auto const iAttachment = UTIL_StrToNum<unsigned>(EvOption[0]);	// arg0: attachment idx.
 						auto const vecEjtPortOfs = UTIL_GetAttachmentOffset(
 							STRING(pPlayer->pev->viewmodel),
 							iAttachment,
@@ -1761,10 +1922,10 @@ public:
 						);
 
 						char szModel[64]{};
-						auto const FmtRes = std::format_to_n(szModel, sizeof(szModel) - 1, "models/{}", EvOption->at(2));
+						auto const FmtRes = std::format_to_n(szModel, sizeof(szModel) - 1, "models/{}", EvOption[2]);
 						szModel[FmtRes.size] = '\0';
 
-						auto const iSoundType = UTIL_StrToNum<TE_BOUNCE>(EvOption->at(3));
+						auto const iSoundType = UTIL_StrToNum<TE_BOUNCE>(EvOption[3]);
 
 						pWeapon->EjectBrass(vecEjtPortOfs, *QcVeclocity, { szModel, (size_t)FmtRes.size }, iSoundType);
 
@@ -1781,36 +1942,29 @@ public:
 						) static noexcept -> Task
 					{
 						// Expecting format: [PL_ATTACHMENT] [RADIUS] [vec3(R, G, B)] [LIFE] [DECAY]
-						auto EvOption = pWeapon->ParseQcScript(pEvent, pAnim);
+						// Or: [PL_ATTACHMENT] default
+						auto const pQcEvent = pWeapon->GetQcEvent(pEvent, pAnim);
 
-						// Handle default val.
-						if (EvOption && EvOption->size() == 2 && sv_icmp_t{}(EvOption->at(1), "default"))
-						{
-							// UTIL_DLight(vecGunOrigin, 4.5f, { 255, 150, 15 }, 0.8f, 15.f);
-							EvOption->at(1) = "4.5";
-							EvOption->push_back("vec3(255, 150, 15)");
-							EvOption->push_back("0.8");
-							EvOption->push_back("15");
-						}
-						else if (!EvOption || EvOption->size() < 5)
+						if (!pQcEvent || pQcEvent->m_Options.size() < 5)
 							co_return;
 
+						auto const& EvOption = pQcEvent->m_Options;
+
 						co_await (pEvent->frame / pAnim->m_fps);
 
 						if (!pWeapon->ShouldQcEventResume(pAnim->m_index))
 							co_return;
 
-						auto const iPlayerAttIdx = UTIL_StrToNum<int>(EvOption->at(0));
-						auto const flRadius = UTIL_StrToNum<float>(EvOption->at(1));
-						auto const QcColor = pWeapon->ExecuteQcScript<Vector>(EvOption->at(2), pAnim);
-						auto const flLife = UTIL_StrToNum<float>(EvOption->at(3));
-						auto const flDecay = UTIL_StrToNum<float>(EvOption->at(4));
+						auto const iPlayerAttIdx = UTIL_StrToNum<int>(EvOption[0]);
+						auto const flRadius = UTIL_StrToNum<float>(EvOption[1]);
+						auto const QcColor = pWeapon->ExecuteQcScript<Vector>(*pQcEvent, 2, pAnim);
+						auto const flLife = UTIL_StrToNum<float>(EvOption[3]);
+						auto const flDecay = UTIL_StrToNum<float>(EvOption[4]);
 
 						if (!QcColor)
 							co_return;
 
-						Vector vecGunOrigin{};
-						g_engfuncs.pfnGetAttachment(pPlayer->edict(), iPlayerAttIdx, vecGunOrigin, nullptr);
+						auto const vecGunOrigin = UTIL_GetEntityAttachment(pPlayer->edict(), iPlayerAttIdx);
 
 						UTIL_DLight(
 							vecGunOrigin, flRadius,
@@ -1832,36 +1986,37 @@ public:
 						) static noexcept -> Task
 					{
 						// Expecting format: [NEW_CLIP_NUM] [NEW_AMMO_NUM]
-						auto EvOption = pWeapon->ParseQcScript(pEvent, pAnim);
+						// Or: [MAG_DIFF]
+						auto const pQcEvent = pWeapon->GetQcEvent(pEvent, pAnim);
 
-						if (!EvOption || EvOption->empty())
+						if (!pQcEvent)
 							co_return;
 
-						if (EvOption->size() == 1 && sv_icmp_t{}(EvOption->at(0), "default"))
-							EvOption->at(0) = "-min(MAXCLIP - CLIP, AMMO)";
-
 						co_await (pEvent->frame / pAnim->m_fps);
 
 						if (!pWeapon->ShouldQcEventResume(pAnim->m_index) || pPlayer != pWeapon->m_pPlayer)
 							co_return;
 
-						DynExprBindNum("CLIP", pWeapon->m_iClip);
-						DynExprBindNum("AMMO", pPlayer->m_rgAmmo[pWeapon->m_iPrimaryAmmoType]);
-						DynExprBindNum("MAXCLIP", T::DAT_MAX_CLIP);
+						// CLIP, AMMO, MAXCLIP, as declared in InitializeDynExpr()
+						double const Frame[] = {
+							(double)pWeapon->m_iClip,
+							(double)pPlayer->m_rgAmmo[pWeapon->m_iPrimaryAmmoType],
+							(double)T::DAT_MAX_CLIP,
+						};
 
-						if (EvOption->size() >= 2)
+						if (pQcEvent->m_Options.size() >= 2)
 						{
-							auto const QcNewClip = pWeapon->ExecuteQcScript<double>(EvOption->at(0), pAnim);
-							auto const QcNewAmmo = pWeapon->ExecuteQcScript<double>(EvOption->at(1), pAnim);
+							auto const QcNewClip = pWeapon->ExecuteQcScript<double>(*pQcEvent, 0, pAnim, Frame);
+							auto const QcNewAmmo = pWeapon->ExecuteQcScript<double>(*pQcEvent, 1, pAnim, Frame);
 
 							if (QcNewClip)
 								pWeapon->m_iClip = std::lround(*QcNewClip);
 							if (QcNewAmmo)
 								pPlayer->m_rgAmmo[pWeapon->m_iPrimaryAmmoType] = std::lround(*QcNewAmmo);
 						}
-						else if (EvOption->size() >= 1)
+						else
 						{
-							auto const QcMagDiff = pWeapon->ExecuteQcScript<double>(EvOption->at(0), pAnim);
+							auto const QcMagDiff = pWeapon->ExecuteQcScript<double>(*pQcEvent, 0, pAnim, Frame);
 
 							if (QcMagDiff)
 							{
@@ -1871,10 +2026,6 @@ public:
 							}
 						}
 
-						DynExprUnbind("CLIP");
-						DynExprUnbind("AMMO");
-						DynExprUnbind("MAXCLIP");
-
 					}(this, m_pPlayer, &Event, pAnim),
 					TASK_EQCEV_DT_CLIP
 				);
@@ -5,8 +5,18 @@ import std.compat;
 #endif
 import hlsdk;
 
+import Ammo;
 import CBase;
 import Plugin;
+import Profiler;
+
+
+// FireBullets.cpp
+extern Vector2D CS_FireBullets3(
+	CBasePlayer* pAttacker, CBasePlayerItem* pInflictor,
+	Vector const& vecSrcOfs, float flSpread, float flDistance,
+	int iPenetration, CAmmoInfo const* pAmmoInfo, float flDamage, float flRangeModifier, int iPellets) noexcept;
+//
 
 
 META_RES OnClientCommand(CBasePlayer* pPlayer, std::string_view szCmd) noexcept
@@ -46,6 +56,60 @@ META_RES OnClientCommand(CBasePlayer* pPlayer, std::string_view szCmd) noexcept
 		pPlayer->GiveShield();
 		return MRES_SUPERCEDE;
 	}
+	else if (szCmd == "wsiv_pellet_bench")
+	{
+		// wsiv_pellet_bench [pellets] [rounds]
+		// No weapon ships with DAT_PELLETS yet, so this is what drives the batched path of CS_FireBullets3.
+		// Fires a buckshot volley where the player aims, once as a single call and once as one call per pellet.
+		// The single-pellet calls share the random seed and land on one spot; compare the trace counts with that in mind.
+		// Damage and impacts are real.
+		if constexpr (Profiler::ENABLED)
+		{
+			auto const iArgc = g_engfuncs.pfnCmd_Argc();
+			auto const iPellets = std::clamp(iArgc > 1 ? std::atoi(g_engfuncs.pfnCmd_Argv(1)) : 12, 1, 64);
+			auto const iRounds = std::clamp(iArgc > 2 ? std::atoi(g_engfuncs.pfnCmd_Argv(2)) : 20, 1, 500);
+
+			auto const pBuckshot = Ammo_InfoByName("Buckshot");
+			auto const pItem = pPlayer->m_pActiveItem;
+
+			if (!pBuckshot || !pItem)
+				return MRES_SUPERCEDE;
+
+			static auto const iClassBatched = Profiler::ClassIndex("wsiv_pellet_bench/batched");
+			static auto const iClassSingle = Profiler::ClassIndex("wsiv_pellet_bench/single");
+
+			// Returns the traces and nanoseconds of one volley.
+			auto const fnVolley = [&](std::uint16_t iClass, int iCalls, int iPelletsPerCall) noexcept
+			{
+				Profiler::timed_shot_t Shot{ iClass };
+
+				for (int i = 0; i < iCalls; ++i)
+					CS_FireBullets3(pPlayer, pItem, g_vecZero, 0.0675f, 3000.f, 1, pBuckshot, 20.f, 0.7f, iPelletsPerCall);
+
+				return std::pair{ Profiler::m_Ring.m_iTraces, Profiler::Elapsed(Shot.m_Start) };
+			};
+
+			std::uint64_t iBatchedTraces{}, iBatchedNanoSec{}, iSingleTraces{}, iSingleNanoSec{};
+
+			for (int i = 0; i < iRounds; ++i)
+			{
+				auto const [iTraces1, iNanoSec1] = fnVolley(iClassBatched, 1, iPellets);
+				auto const [iTraces2, iNanoSec2] = fnVolley(iClassSingle, iPellets, 1);
+
+				iBatchedTraces += iTraces1; iBatchedNanoSec += iNanoSec1;
+				iSingleTraces += iTraces2; iSingleNanoSec += iNanoSec2;
+			}
+
+			g_engfuncs.pfnServerPrint(std::format(
+				"[WSIV] {} pellets x {} rounds - batched: {:.1f} traces, {:.1f} us per shot; one call per pellet: {:.1f} traces, {:.1f} us per shot\n",
+				iPellets, iRounds,
+				(double)iBatchedTraces / iRounds, (double)iBatchedNanoSec / iRounds / 1000.0,
+				(double)iSingleTraces / iRounds, (double)iSingleNanoSec / iRounds / 1000.0
+			).c_str());
+		}
+
+		return MRES_SUPERCEDE;
+	}
 
 	return MRES_IGNORED;
 }
@@ -6,6 +6,7 @@ import hlsdk;
 import CBase;
 import ConditionZero;
 import Decal;
+import EffectPool;
 import Engine;
 import FileSystem;
 import GameRules;
@@ -25,6 +26,9 @@ import BPW;
 import WpnIdAllocator;
 
 import Hook;
+import ImpactBudget;
+import Profiler;
+import TextureCache;
 import Plugin;
 import WinAPI;
 
@@ -40,10 +44,46 @@ extern void DeployRoundHook() noexcept;
 
 // DynExpr.cpp
 extern void InitializeDynExpr() noexcept;
+extern void DynExprBenchmark(std::size_t iFuzzCount) noexcept;
+//
+
+// CsWpn.cpp
+extern void ClearQcEventCache() noexcept;
+//
+
+// Effects.cpp
+extern void ThinkEffects() noexcept;
+extern void ClearEffects() noexcept;
+//
+
+// FireBullets.cpp
+extern void LoadMaterials() noexcept;
+extern void FlushImpacts() noexcept;
+extern void ClearWaterSurfaces() noexcept;
 //
 
 static bool g_bShouldPrecache = true;
 
+// One file per map, overwritten when the map comes around again.
+static void WriteProfileToFile() noexcept
+{
+	char szGameDir[32]{};
+	g_engfuncs.pfnGetGameDir(szGameDir);
+
+	std::filesystem::path LogFilePath = szGameDir;
+	LogFilePath /= std::format("addons/metamod/logs/WSIV_Profile_{}.csv", STRING(gpGlobals->mapname));
+	auto const LogFolder = LogFilePath.parent_path();
+
+	if (!std::filesystem::exists(LogFolder))
+		std::filesystem::create_directories(LogFolder);
+
+	if (auto f = std::fopen(LogFilePath.u8string().c_str(), "wt"); f)
+	{
+		Profiler::WriteCsv(f);
+		std::fclose(f);
+	}
+}
+
 
 void fw_GameInit_Post() noexcept
 {
@@ -54,6 +94,101 @@ void fw_GameInit_Post() noexcept
 	RetrieveServerVariables();
 	InitializeDynExpr();
 
+	// wsiv_dynexpr_bench [fuzz_count]
+	g_engfuncs.pfnAddServerCommand("wsiv_dynexpr_bench", +[]() noexcept
+	{
+		auto const iFuzzCount = g_engfuncs.pfnCmd_Argc() >= 2 ? std::strtoul(g_engfuncs.pfnCmd_Argv(1), nullptr, 10) : 0ul;
+		DynExprBenchmark(iFuzzCount);
+	});
+
+	g_engfuncs.pfnAddServerCommand("wsiv_impact_stats", +[]() noexcept
+	{
+		auto const& Stats = ImpactBudget::m_Stats;
+
+		g_engfuncs.pfnServerPrint(std::format(
+			"[WSIV] Impacts: {} queued, {} merged, {} played.\n"
+			"[WSIV] Dropped: {} decals, {} tracers, {} sounds, {} cosmetics.\n"
+			"[WSIV] Peak {} bytes per client frame, budget {}.\n",
+			Stats.m_iQueued, Stats.m_iMerged, Stats.m_iPlanned,
+			Stats.m_iDecalsDropped, Stats.m_iTracersDropped, Stats.m_iAudioDropped, Stats.m_iCosmeticDropped,
+			Stats.m_iPeakBytes, ImpactBudget::BYTES_PER_CLIENT_FRAME
+		).c_str());
+
+		std::string szLastFrame{ "[WSIV] Last frame, bytes by client:" };
+
+		for (auto&& [iSlot, iBytes] : Stats.m_rgiLastBytes | std::views::enumerate)
+		{
+			if (iBytes)
+				std::format_to(std::back_inserter(szLastFrame), " #{}:{}", iSlot + 1, iBytes);
+		}
+
+		szLastFrame += '\n';
+		g_engfuncs.pfnServerPrint(szLastFrame.c_str());
+	});
+
+	g_engfuncs.pfnAddServerCommand("wsiv_effect_stats", +[]() noexcept
+	{
+		auto const& Pool = EffectPool::m_Pool;
+
+		g_engfuncs.pfnServerPrint(std::format(
+			"[WSIV] Effects: {} live, {} peak, {} edicts of {}.\n"
+			"[WSIV] {} spawned, {} evicted, {} rejected.\n",
+			Pool.m_iLive, Pool.m_Stats.m_iPeak, Pool.m_iHandles, Pool.Capacity(),
+			Pool.m_Stats.m_iSpawned, Pool.m_Stats.m_iEvicted, Pool.m_Stats.m_iRejected
+		).c_str());
+	});
+
+	g_engfuncs.pfnAddServerCommand("wsiv_attachment_stats", +[]() noexcept
+	{
+		auto const& Stats = gAttachmentStats;
+
+		g_engfuncs.pfnServerPrint(std::format(
+			"[WSIV] Attachment offsets: {} hits, {} misses, {} baked on precache.\n"
+			"[WSIV] Entity attachments: {} hits, {} misses.\n",
+			Stats.m_iOffsetHits, Stats.m_iOffsetMisses, Stats.m_iOffsetBaked,
+			Stats.m_iEntityHits, Stats.m_iEntityMisses
+		).c_str());
+	});
+
+	g_engfuncs.pfnAddServerCommand("wsiv_texture_stats", +[]() noexcept
+	{
+		auto const& Stats = TextureCache::m_Stats;
+		auto const iResolved = Stats.m_iHits + Stats.m_iMisses;
+
+		g_engfuncs.pfnServerPrint(std::format(
+			"[WSIV] Texture types: {} loaded, {} surfaces cached.\n"
+			"[WSIV] {} lookups: {} hits ({:.1f}%), {} misses, {} flesh, {} untextured.\n",
+			Stats.m_iTypes, TextureCache::m_Surfaces.size(),
+			Stats.m_iLookups, Stats.m_iHits, iResolved ? 100.0 * Stats.m_iHits / iResolved : 0.0,
+			Stats.m_iMisses, Stats.m_iFlesh, Stats.m_iUntextured
+		).c_str());
+	});
+
+	// wsiv_profile [reset]
+	g_engfuncs.pfnAddServerCommand("wsiv_profile", +[]() noexcept
+	{
+		if constexpr (!Profiler::ENABLED)
+		{
+			g_engfuncs.pfnServerPrint("[WSIV] Profiler is compiled out, build with WSIV_PROFILE defined.\n");
+			return;
+		}
+
+		Profiler::Flush();
+
+		if (g_engfuncs.pfnCmd_Argc() >= 2 && !std::strcmp(g_engfuncs.pfnCmd_Argv(1), "reset"))
+		{
+			Profiler::Reset();
+			return;
+		}
+
+		// ServerPrint cannot take the whole table at once.
+		for (auto&& szLine : Profiler::Report() | std::views::split('\n'))
+		{
+			if (!szLine.empty())
+				g_engfuncs.pfnServerPrint(std::format("[WSIV] {}\n", std::string_view{ szLine }).c_str());
+		}
+	});
+
 	DeployInlineHooks();
 
 	// post
@@ -77,6 +212,7 @@ void fw_ServerActivate_Post(edict_t* pEdictList, int edictCount, int clientMax)
 	Decal::RetrieveIndices();
 	ZBot::RetrieveManager();
 	RetrieveEngineStudio();
+	BakeAttachmentOffsets();	// Queued by weapon precache.
 	ResetAllSlotManagers();
 
 	Resource::LogToFile();
@@ -91,12 +227,66 @@ void fw_ServerDeactivate_Post() noexcept
 	// Precache should be done across on every map change.
 	g_bShouldPrecache = true;
 	Resource::Clear();
+	ClearQcEventCache();	// Keyed by events inside the studio transcriptions just cleared.
+	ClearWaterSurfaces();
+	ClearAttachmentCache();
+	TextureCache::Clear();
 
 	// CGameRules class is re-install every map change. Hence we should re-hook it everytime.
 	g_pGameRules = nullptr;
 
 	// Remove ALL existing tasks.
 	TaskScheduler::Clear();
+	ImpactBudget::Clear();
+	ClearEffects();
+
+	if constexpr (Profiler::ENABLED)
+	{
+		Profiler::Flush();
+		WriteProfileToFile();
+		Profiler::Reset();
+	}
+}
+
+void fw_StartFrame_Post() noexcept
+{
+	static auto const iWorld = Profiler::ClassIndex("world");
+
+	{
+		// Impacts and muzzle effects are played out here, frames after their shot. Count them against the world.
+		Profiler::shot_t Frame{ iWorld };
+
+		TaskScheduler::Think();
+
+		{
+			Profiler::scope_t Scope{ Profiler::STAGE_BULLET_IMPACT, iWorld };
+			FlushImpacts();	// After Think(), so the fresh effects start on this frame instead of skipping one stage.
+		}
+
+		{
+			Profiler::scope_t Scope{ Profiler::STAGE_EFFECTS, iWorld };
+			ThinkEffects();
+		}
+	}
+
+	if constexpr (Profiler::ENABLED)
+		Profiler::Flush();
+}
+
+void fw_TraceLine(const float* v1, const float* v2, int fNoMonsters, edict_t* pentToSkip, TraceResult* ptr) noexcept
+{
+	// pre
+	gpMetaGlobals->mres = MRES_IGNORED;
+
+	Profiler::OnTraceLine();
+}
+
+void fw_MessageBegin(int msg_dest, int msg_type, const float* pOrigin, edict_t* ed) noexcept
+{
+	// pre
+	gpMetaGlobals->mres = MRES_IGNORED;
+
+	Profiler::OnMessageBegin();
 }
 
 auto fw_Spawn(edict_t* pEdict) noexcept -> qboolean
@@ -113,6 +303,8 @@ auto fw_Spawn(edict_t* pEdict) noexcept -> qboolean
 	Resource::PrecacheEverything();
 	PrecacheCombinedModels();
 	PrecacheShieldModel();
+	LoadMaterials();
+	TextureCache::Load();
 
 	g_bShouldPrecache = false;
 	return 0;
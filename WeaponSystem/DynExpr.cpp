@@ -9,14 +9,93 @@ using namespace std;
 
 #include "DynExpr.hpp"
 
+// Scripts come from model files. Bad arguments must yield garbage, never UB or an assertion in the STL.
+
+static double Random(double low, double high) noexcept
+{
+	return UTIL_Random(std::min(low, high), std::max(low, high));
+}
+
+static double RandomInt(double low, double high) noexcept
+{
+	return (double)UTIL_Random(std::lround(std::min(low, high)), std::lround(std::max(low, high)));
+}
+
+static double Quotient(double dividend, double divisor) noexcept
+{
+	// Same as integer division within the range of int32, exact there. Division by zero gives inf or NaN.
+	return std::trunc(std::trunc(dividend) / std::trunc(divisor));
+}
+
+static double Clamp(double v, double lo, double hi) noexcept
+{
+	// std::clamp() asserts lo <= hi. This is what it gives in release build otherwise.
+	return std::min(std::max(v, lo), hi);
+}
+
+static double ShiftLeft(double lhs, double rhs) noexcept
+{
+	using U = std::make_unsigned_t<long>;
+	auto const n = std::lround(rhs);
+
+	if (n < 0 || n >= std::numeric_limits<U>::digits)
+		return 0;
+
+	return (double)(long)((U)std::lround(lhs) << n);
+}
+
+static double ShiftRight(double lhs, double rhs) noexcept
+{
+	auto const n = std::lround(rhs);
+	auto const v = std::lround(lhs);
+
+	if (n < 0 || n >= std::numeric_limits<std::make_unsigned_t<long>>::digits)
+		return v < 0 ? -1 : 0;
+
+	return (double)(v >> n);
+}
+
 void InitializeDynExpr() noexcept
 {
 	static bool bInit = false;
 	if (bInit)
 		return;
 
-	DynExpr::BindConstant<Vector>("vecZero", Vector{});
-	DynExpr::BindConstant<double>("NaN", std::numeric_limits<double>::quiet_NaN());
+	DynExpr::FixConstant<double>(u8"e", std::numbers::e);
+	DynExpr::FixConstant<double>(u8"ϕ", std::numbers::phi);
+	DynExpr::FixConstant<double>(u8"phi", std::numbers::phi);
+	DynExpr::FixConstant<double>(u8"π", std::numbers::pi);
+	DynExpr::FixConstant<double>(u8"pi", std::numbers::pi);
+
+	// SI defining constants
+
+	DynExpr::FixConstant<double>(u8"h", 6.62607015e-34);		// Planck constant (ℎ/ℏ)
+	DynExpr::FixConstant<double>(u8"e[0]", 1.602176634e-19);	// Elementary charge
+	DynExpr::FixConstant<double>(u8"k[B]", 1.380649e-23);		// Boltzmann constant
+	DynExpr::FixConstant<double>(u8"N[A]", 6.022'14076e23);	// Avogadro constant
+	DynExpr::FixConstant<double>(u8"c", 299'792'458);			// Speed of light in vacuum
+	DynExpr::FixConstant<double>(u8"ΔνCs", 9.192'631'770e9);	// Unperturbed ground-state hyperfine transition frequency of the cesium-133 atom
+	DynExpr::FixConstant<double>(u8"K[cd]", 683);				// Luminous efficacy of monochromatic radiation of frequency 540×10^12 hertz
+
+	// Faraday constant			F
+	// Gravitational constant	G
+	// Conductance quantum		G[0]
+	// Molar gas constant		R
+	// Electron volt			eV
+	// Standard gravity			g
+	// Electron mass			m[e]
+	// Proton mass				m[p]
+	// Atomic mass constant		m[u]
+	// Electric constant		ε[0]
+	// Magnetic constant		μ[0]
+
+	DynExpr::FixConstant<Vector>("vecZero", Vector{});
+	DynExpr::FixConstant<double>("NaN", std::numeric_limits<double>::quiet_NaN());
+
+	// Frame layout of the clip event, CsWpn.cpp builds its frame in the same order.
+	DynExpr::DeclareVariable("CLIP");
+	DynExpr::DeclareVariable("AMMO");
+	DynExpr::DeclareVariable("MAXCLIP");
 
 	DynExpr::BindFunction("vec3", +[](double x, double y, double z) noexcept { return Vector{ x, y, z }; });
 	DynExpr::BindFunction("vec2", +[](double x, double y) noexcept { return Vector2D{ (float)x, (float)y, }; });
@@ -53,22 +132,22 @@ void InitializeDynExpr() noexcept
 	DynExpr::BindOperator("|", EAssociativity::Left, OpPrec_BitOR, +[](double lhs, double rhs) -> double { return std::lround(lhs) | std::lround(rhs); });
 	DynExpr::BindOperator("^", EAssociativity::Left, OpPrec_BitXOR, +[](double lhs, double rhs) -> double { return std::lround(lhs) ^ std::lround(rhs); });
 	DynExpr::BindOperator("~", EAssociativity::Right, OpPrec_Unary, +[](double operand) -> double { return ~std::lround(operand); });
-	DynExpr::BindOperator("<<", EAssociativity::Left, OpPrec_BitShift, +[](double lhs, double rhs) -> double { return std::lround(lhs) << std::lround(rhs); });
-	DynExpr::BindOperator(">>", EAssociativity::Left, OpPrec_BitShift, +[](double lhs, double rhs) -> double { return std::lround(lhs) >> std::lround(rhs); });
+	DynExpr::BindOperator("<<", EAssociativity::Left, OpPrec_BitShift, &ShiftLeft);
+	DynExpr::BindOperator(">>", EAssociativity::Left, OpPrec_BitShift, &ShiftRight);
 
 	// Random
-	DynExpr::BindFunction("rd", &UTIL_Random<double>);
-	DynExpr::BindFunction("rand", &UTIL_Random<double>);
-	DynExpr::BindFunction("random", &UTIL_Random<double>);
-	DynExpr::BindFunction("randi", +[](double low, double high) { return (double)UTIL_Random(std::lround(low), std::lround(high)); });
+	DynExpr::BindFunction("rd", &Random).m_bPure = false;
+	DynExpr::BindFunction("rand", &Random).m_bPure = false;
+	DynExpr::BindFunction("random", &Random).m_bPure = false;
+	DynExpr::BindFunction("randi", &RandomInt).m_bPure = false;
 
 	// Basic
 	DynExpr::BindFunction("abs", static_cast<double (*)(double)>(&std::abs));
 	DynExpr::BindFunction("rem", static_cast<double (*)(double, double)>(&std::fmod));
-	DynExpr::BindFunction("quot", +[](double dividend, double divisor) { auto r = std::div((int32_t)dividend, (int32_t)divisor); return r.quot; });
+	DynExpr::BindFunction("quot", &Quotient);
 	DynExpr::BindFunction("max", static_cast<double (*)(double, double)>(&std::fmax));
 	DynExpr::BindFunction("min", static_cast<double (*)(double, double)>(&std::fmin));
-	DynExpr::BindFunction("clamp", &std::clamp<double>);
+	DynExpr::BindFunction("clamp", &Clamp);
 
 	// Rounding
 	DynExpr::BindFunction("ceil", static_cast<double (*)(double)>(&std::ceil));
@@ -100,26 +179,256 @@ void InitializeDynExpr() noexcept
 	bInit = true;
 }
 
-auto RunDynExpr(string_view szExpr) noexcept -> expected<any, string>
+// Compiled programs, keyed by their source text. The set of QC expressions is small and fixed per model.
+static map<string, DynExpr::Program, std::ranges::less> gCompiledExpr{};
+
+auto CompileDynExpr(string_view szExpr) noexcept -> expected<DynExpr::Program const*, string>
 {
-	return
-		DynExpr::Tokenizer(szExpr)
-		.or_else([](error_t const& err) noexcept -> expected<vector<string_view>, string> { return std::unexpected(err.ToString()); })
-		.and_then(&DynExpr::ShuntingYardAlgorithm)
-		.and_then(&DynExpr::Execute<any>);
+	if (auto const it = gCompiledExpr.find(szExpr); it != gCompiledExpr.cend())
+		return &it->second;
+
+	return DynExpr::Compile(szExpr)
+		.transform([&](DynExpr::Program&& prog) noexcept -> DynExpr::Program const*
+		{
+#ifdef _DEBUG
+			g_engfuncs.pfnServerPrint(
+				std::format("[WSIV] DynExpr folded {}/{} instructions ({:.0f}%): {}\n",
+					prog.m_iUnfoldedSize - prog.m_Instructions.size(), prog.m_iUnfoldedSize,
+					100.0 * double(prog.m_iUnfoldedSize - prog.m_Instructions.size()) / double(std::max<size_t>(prog.m_iUnfoldedSize, 1)),
+					szExpr
+				).c_str()
+			);
+#endif
+			return &gCompiledExpr.try_emplace(string{ szExpr }, std::move(prog)).first->second;
+		});
 }
 
-void DynExprBindVector(string_view name, Vector const& vec) noexcept
+template <typename T>
+auto ExecuteDynExpr(DynExpr::Program const* pProg, span<double const> Frame) noexcept -> expected<T, string>
 {
-	DynExpr::BindConstant<Vector>(name, vec);
+	return DynExpr::Execute<T>(*pProg, Frame);
+}
+
+template auto ExecuteDynExpr<double>(DynExpr::Program const* pProg, span<double const> Frame) noexcept -> expected<double, string>;
+template auto ExecuteDynExpr<Vector>(DynExpr::Program const* pProg, span<double const> Frame) noexcept -> expected<Vector, string>;
+
+template <typename T>
+auto ExecuteDynExprBatch(DynExpr::Program const* pProg, span<double const> Frames, span<T> Out) noexcept -> expected<void, string>
+{
+	return DynExpr::ExecuteBatch<T>(*pProg, Frames, Out);
 }
 
-void DynExprBindNum(string_view name, double num) noexcept
+template auto ExecuteDynExprBatch<double>(DynExpr::Program const* pProg, span<double const> Frames, span<double> Out) noexcept -> expected<void, string>;
+template auto ExecuteDynExprBatch<Vector>(DynExpr::Program const* pProg, span<double const> Frames, span<Vector> Out) noexcept -> expected<void, string>;
+
+void DynExprBindVector(string_view name, Vector const& vec) noexcept
 {
-	DynExpr::BindConstant<double>(name, num);
+	DynExpr::BindConstant<Vector>(name, vec);
 }
 
-void DynExprUnbind(string_view name) noexcept
+// Stress the whole pipeline, from tokenizer to evaluation, with the server itself as the harness.
+// The benchmark times each stage separately over a fixed corpus, so a regression shows where it is.
+// Batched evaluation is timed at growing batch sizes and checked bit for bit against the scalar path.
+// The fuzzer feeds token soup from a fixed seed and logs every input before running it, so a crash leaves the offending one last in the log.
+void DynExprBenchmark(std::size_t iFuzzCount) noexcept
 {
-	DynExpr::BindConstant<void>(name);
+	using clock_t = std::chrono::steady_clock;
+
+	static constexpr string_view CORPUS[] = {
+		"-min(MAXCLIP - CLIP, AMMO)",
+		"vec3(25, -rand(85, 110), rand(85, 110))",
+		"vec3(255, 150, 15)",
+		"MAXCLIP - CLIP",
+		"clamp(AMMO - (MAXCLIP - CLIP), 0, AMMO)",
+		"vec3(vec2(1, 2), 3) ⋅ vec3(4, 5, 6) * CLIP",
+		"hypot(CLIP, AMMO, MAXCLIP) ** 0.5 + (0x10 | 0b11) << 2",
+		"(vec3(1, 2, 3) × vec3(CLIP, AMMO, MAXCLIP)).z / len(vec3(1, 1, 1))",
+	};
+	static constexpr double FRAME[] = { 7, 90, 13 };
+	static constexpr int ROUNDS = 2000;
+
+	auto const fnRate = [](clock_t::duration dur) noexcept
+	{
+		auto const flSeconds = std::chrono::duration<double>(dur).count();
+		return flSeconds > 0 ? double(ROUNDS * std::size(CORPUS)) / flSeconds : 0.0;
+	};
+
+	// Nothing in here binds, so the symbol tables must come out exactly as they went in.
+	auto const fnTableSizes = []() noexcept
+	{
+		return std::array{ DynExpr::m_Symbols.m_Names.size(), DynExpr::m_Functions.size(), DynExpr::m_Constants.size(), DynExpr::m_Variables.size(), DynExpr::m_ClassMembers.size() };
+	};
+	auto const fnCheckTables = [&, TableSizes = fnTableSizes()](string_view szStage) noexcept
+	{
+		if (fnTableSizes() != TableSizes) [[unlikely]]
+			g_engfuncs.pfnServerPrint(std::format("[WSIV] DynExpr {} - symbol tables were modified by lookups!\n", szStage).c_str());
+	};
+
+	clock_t::duration durTokenize{}, durParse{}, durCompile{}, durExecute{};
+
+	for (auto&& szExpr : CORPUS)
+	{
+		auto const pProg = CompileDynExpr(szExpr);
+		if (!pProg)
+		{
+			g_engfuncs.pfnServerPrint(std::format("[WSIV] DynExpr bench - '{}' does not compile:\n{}\n", szExpr, pProg.error()).c_str());
+			return;
+		}
+
+		auto& Arena = DynExpr::m_Arena;
+		vector<string_view> Tokens{};
+		std::ignore = DynExpr::Tokenizer(szExpr, Tokens);
+		auto t = clock_t::now();
+
+		for (int i = 0; i < ROUNDS; ++i)
+			std::ignore = DynExpr::Tokenizer(szExpr, Arena.m_Tokens);
+		durTokenize += clock_t::now() - t; t = clock_t::now();
+
+		for (int i = 0; i < ROUNDS; ++i)
+			std::ignore = DynExpr::ShuntingYardAlgorithm(Tokens, Arena.m_Rpn, Arena.m_OpStack);
+		durParse += clock_t::now() - t; t = clock_t::now();
+
+		for (int i = 0; i < ROUNDS; ++i)
+			std::ignore = DynExpr::Compile(szExpr, Arena);
+		durCompile += clock_t::now() - t; t = clock_t::now();
+
+		for (int i = 0; i < ROUNDS; ++i)
+			std::ignore = DynExpr::Execute<DynExpr::value_t>(**pProg, FRAME);
+		durExecute += clock_t::now() - t;
+	}
+
+	g_engfuncs.pfnServerPrint(
+		std::format("[WSIV] DynExpr bench - per second: {:.0f} tokenized, {:.0f} parsed, {:.0f} compiled, {:.0f} executed\n",
+			fnRate(durTokenize), fnRate(durParse), fnRate(durCompile), fnRate(durExecute)
+		).c_str()
+	);
+
+	// Per element, in SoA layout: CLIP, AMMO and MAXCLIP of every element in turn.
+	static constexpr std::size_t MAX_BATCH = 64;
+	std::array<double, std::size(FRAME) * MAX_BATCH> Frames{};
+	std::array<DynExpr::value_t, MAX_BATCH> Results{};
+	string szRates{};
+	std::size_t iMismatches{};
+
+	for (std::size_t N = 1; N <= MAX_BATCH; N *= 2)
+	{
+		for (std::size_t v = 0; v < std::size(FRAME); ++v)
+			for (std::size_t i = 0; i < N; ++i)
+				Frames[v * N + i] = FRAME[v] + (double)i;
+
+		auto const FramesView = span{ Frames }.first(std::size(FRAME) * N);
+		auto const ResultsView = span{ Results }.first(N);
+		auto const iRounds = std::max<std::size_t>(ROUNDS / N, 1);
+		auto const t = clock_t::now();
+
+		for (auto&& szExpr : CORPUS)
+		{
+			auto const pProg = *CompileDynExpr(szExpr);
+
+			for (std::size_t r = 0; r < iRounds; ++r)
+				std::ignore = DynExpr::ExecuteBatch<DynExpr::value_t>(*pProg, FramesView, ResultsView);
+		}
+
+		auto const flSeconds = std::chrono::duration<double>(clock_t::now() - t).count();
+		szRates += std::format(" N={}: {:.0f}", N, flSeconds > 0 ? double(iRounds * N * std::size(CORPUS)) / flSeconds : 0.0);
+
+		// Randomness aside, every element must match its scalar evaluation.
+		for (auto&& szExpr : CORPUS)
+		{
+			auto const pProg = *CompileDynExpr(szExpr);
+
+			if (!std::ranges::all_of(pProg->m_Instructions, [](DynExpr::instr_t const& ins) noexcept { return ins.m_OpCode != DynExpr::EOpCode::Call || ins.m_pFunction->m_bPure; }))
+				continue;
+
+			std::ignore = DynExpr::ExecuteBatch<DynExpr::value_t>(*pProg, FramesView, ResultsView);
+
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				double const Frame[] = { Frames[i], Frames[N + i], Frames[2 * N + i] };
+				auto const Scalar = DynExpr::Execute<DynExpr::value_t>(*pProg, Frame);
+
+				iMismatches += !Scalar || Scalar->index() != Results[i].index()
+					|| std::visit([&](auto const& lhs) noexcept { return std::memcmp(&lhs, &std::get<std::decay_t<decltype(lhs)>>(Results[i]), sizeof(lhs)) != 0; }, *Scalar);
+			}
+		}
+	}
+
+	g_engfuncs.pfnServerPrint(std::format("[WSIV] DynExpr batch - elements per second:{}. {} mismatch(es) against scalar\n", szRates, iMismatches).c_str());
+
+	fnCheckTables("bench");
+
+	if (!iFuzzCount)
+		return;
+
+	// Everything the engine knows, plus what a broken QC line would bring in.
+	vector<string_view> Vocabulary{ "(", ")", ",", " ", "0", "1", "-1", "2.5", "1e308", "0x7FFFFFFF", "0b101", "0o17", "NaN", "\"str\"", "'c'", "--", "#", "\xFF" };
+	Vocabulary.append_range(DynExpr::m_Functions.keys());
+	Vocabulary.append_range(DynExpr::m_Constants.keys());
+	Vocabulary.append_range(DynExpr::m_Variables.keys());
+	Vocabulary.append_range(DynExpr::m_ClassMembers.keys());
+
+	static constexpr std::uint32_t FUZZ_SEED = 20250101;
+	static constexpr char FUZZ_LOG[] = "addons/metamod/logs/WSIV_DynExprFuzz.log";
+	std::mt19937 Rng{ FUZZ_SEED };
+
+	// The console can't keep up with one line per input, a file flushed after each line can.
+	char szGameDir[32]{};
+	g_engfuncs.pfnGetGameDir(szGameDir);
+
+	std::filesystem::path LogFilePath = szGameDir;
+	LogFilePath /= FUZZ_LOG;
+	auto const LogFolder = LogFilePath.parent_path();
+
+	if (!std::filesystem::exists(LogFolder))
+		std::filesystem::create_directories(LogFolder);
+
+	auto const f = std::fopen(LogFilePath.u8string().c_str(), "wt");
+
+	g_engfuncs.pfnServerPrint(
+		std::format("[WSIV] DynExpr fuzz - seed {}, {} inputs, {}\n", FUZZ_SEED, iFuzzCount, f ? std::format("logged to {}", FUZZ_LOG) : "log file unavailable").c_str()
+	);
+
+	string szExpr{};
+	std::size_t iCompiled{}, iExecuted{};
+	clock_t::duration durSlowest{};
+	string szSlowest{};
+
+	for (std::size_t n = 0; n < iFuzzCount; ++n)
+	{
+		szExpr.clear();
+
+		for (auto i = Rng() % 16; i > 0; --i)
+			szExpr += Vocabulary[Rng() % Vocabulary.size()];
+
+		if (f)
+		{
+			std::print(f, "#{}: {}\n", n, szExpr);
+			std::fflush(f);
+		}
+
+		auto const t = clock_t::now();
+
+		if (auto const pProg = DynExpr::Compile(szExpr); pProg)
+		{
+			++iCompiled;
+			iExecuted += DynExpr::Execute<DynExpr::value_t>(*pProg, FRAME).has_value();
+		}
+
+		if (auto const dur = clock_t::now() - t; dur > durSlowest)
+		{
+			durSlowest = dur;
+			szSlowest = szExpr;
+		}
+	}
+
+	if (f)
+		std::fclose(f);
+
+	g_engfuncs.pfnServerPrint(
+		std::format("[WSIV] DynExpr fuzz - {} inputs, {} compiled, {} executed. Slowest {:.3f} ms: {}\n",
+			iFuzzCount, iCompiled, iExecuted, std::chrono::duration<double, std::milli>(durSlowest).count(), szSlowest
+		).c_str()
+	);
+
+	fnCheckTables("fuzz");
 }
@@ -235,12 +235,13 @@ template <
 	auto fnIsParenthesis,	/* Is the string considered as parenthesizes? SIG: bool (*)(string_view token) */
 	auto fnIsOperator		/* Is the string considered as an operator? SIG: bool (*)(string_view token) */
 >
-constexpr auto Tokenizer(string_view s, string_view separators = " \t\f\v\r\n") noexcept -> expected<vector<string_view>, error_t>
+constexpr auto Tokenizer(string_view s, vector<string_view>& ret, string_view separators = " \t\f\v\r\n") noexcept -> expected<void, error_t>
 {
 	// 1. Parse the string as long as possible, like pre-c++11
 	// 2. Kicks off the last character then check again.
 
-	vector<string_view> ret{};
+	// Output is owned by the caller, its capacity is reused from one call to the next.
+	ret.clear();
 	ret.reserve(s.size());
 
 	bool bAllowSignOnNext = true;	// Should not being reset inter-tokens
@@ -275,7 +276,7 @@ constexpr auto Tokenizer(string_view s, string_view separators = " \t\f\v\r\n")
 			error_t err{
 				std::unexpect,	// overload selection
 				s,
-				std::move(ret),
+				ret,
 				std::format("Tokenizer error: Unrecognized symbol '{}' found at pos {}", UTIL_GraphemeAt(s, pos), pos),
 			};
 
@@ -286,7 +287,7 @@ constexpr auto Tokenizer(string_view s, string_view separators = " \t\f\v\r\n")
 			pos += len;
 	}
 
-	return std::move(ret);	// Move into expected<>
+	return {};
 }
 
 struct op_context_t final
@@ -305,7 +306,7 @@ struct token_t final
 	// provided there are 2 arguments pushed onto the stack.
 
 	string_view m_Symbol{};
-	optional<uint8_t> m_OperandCount{};	// Doesn't exist means not operator.
+	optional<uint8_t> m_OperandCount{};	// Operands of an operator, or arguments of a function call. Doesn't exist for operands.
 };
 
 template <
@@ -316,10 +317,11 @@ template <
 	auto fnGetPrecedence,		/* Get associativity of an operator. SIG: int (*)(op_context_t const& OpContext, span<string_view const> tokens) */
 	auto fnGetOperandCount		/* How many operand does this operator needed? SIG: optional<uint8_t> (*)(op_context_t const& OpContext, span<string_view const> tokens) */
 >
-constexpr auto ShuntingYardAlgorithm(span<string_view const> tokens) noexcept -> expected<vector<token_t>, string>
+constexpr auto ShuntingYardAlgorithm(span<string_view const> tokens, vector<token_t>& ret, vector<op_context_t>& op_stack) noexcept -> expected<void, string>
 {
-	vector<token_t> ret{};
-	vector<op_context_t> op_stack{};
+	// Both are owned by the caller, their capacity is reused from one call to the next.
+	ret.clear();
+	op_stack.clear();
 
 	for (ptrdiff_t i = 0; i < std::ssize(tokens); ++i)
 	{
@@ -352,7 +354,12 @@ constexpr auto ShuntingYardAlgorithm(span<string_view const> tokens) noexcept ->
 				.m_Position = i,
 			};
 
-			auto const o1_preced = *fnGetPrecedence(OpContext, tokens);
+			auto const o1_preced = fnGetPrecedence(OpContext, tokens);
+			auto const o1_left_assoc = fnIsLeftAssociative(OpContext, tokens);
+
+			// Operator exists, but none of its overloads takes as many operands as this context offers.
+			if (!o1_preced || !o1_left_assoc) [[unlikely]]
+				return std::unexpected(std::format("SYA error: No overload of operator '{}' fits at pos {}", token, i));
 
 			/*
 			while (
@@ -363,8 +370,9 @@ constexpr auto ShuntingYardAlgorithm(span<string_view const> tokens) noexcept ->
 			push o1 onto the operator stack
 			*/
 
+			// Everything on the op stack had been checked when it was pushed.
 			while (!op_stack.empty() && op_stack.back().m_Op != "("
-				&& (*fnGetPrecedence(op_stack.back(), tokens) > o1_preced || (*fnGetPrecedence(op_stack.back(), tokens) == o1_preced && *fnIsLeftAssociative(OpContext, tokens)))
+				&& (*fnGetPrecedence(op_stack.back(), tokens) > *o1_preced || (*fnGetPrecedence(op_stack.back(), tokens) == *o1_preced && *o1_left_assoc))
 				)
 			{
 				ret.push_back({ op_stack.back().m_Op, fnGetOperandCount(op_stack.back(), tokens) });
@@ -381,33 +389,21 @@ constexpr auto ShuntingYardAlgorithm(span<string_view const> tokens) noexcept ->
 		// )
 		else if (token.length() == 1 && token[0] == ')')
 		{
-			try
+			while (!op_stack.empty() && op_stack.back().m_Op != "(")
 			{
-				while (op_stack.back().m_Op != "(")
-				{
-					// { assert the operator stack is not empty }
-					assert(!op_stack.empty());
-
-					// pop the operator from the operator stack into the output queue
-
-					ret.push_back({ op_stack.back().m_Op, fnGetOperandCount(op_stack.back(), tokens) });
-					op_stack.pop_back();
-				}
+				// pop the operator from the operator stack into the output queue
 
-#ifdef _DEBUG
-				assert(op_stack.back().m_Op[0] == '(');
-#else
-				if (op_stack.back().m_Op[0] != '(') [[unlikely]]
-					return std::unexpected("SYA error: Top of the stack is not a '(' - assertion failed");
-#endif
-				// pop the left parenthesis from the operator stack and discard it
+				ret.push_back({ op_stack.back().m_Op, fnGetOperandCount(op_stack.back(), tokens) });
 				op_stack.pop_back();
 			}
-			catch (...)
-			{
-				/* If the stack runs out without finding a left parenthesis, then there are mismatched parentheses. */
-				return std::unexpected("SYA error: Mismatched parentheses");
-			}
+
+			/* If the stack runs out without finding a left parenthesis, then there are mismatched parentheses. */
+			if (op_stack.empty()) [[unlikely]]
+				return std::unexpected(std::format("SYA error: Mismatched parentheses at pos {}", i));
+
+			// pop the left parenthesis from the operator stack and discard it
+			auto const iOpenParen = op_stack.back().m_Position;
+			op_stack.pop_back();
 
 			/*
 			if there is a function token at the top of the operator stack, then:
@@ -415,7 +411,27 @@ constexpr auto ShuntingYardAlgorithm(span<string_view const> tokens) noexcept ->
 			*/
 			if (!op_stack.empty() && fnIsFunction(op_stack.back().m_Op))
 			{
-				ret.push_back({ op_stack.back().m_Op, nullopt });
+				// Count the arguments if this is its call parenthesis, so overloads differ in arity can be told apart.
+				optional<uint8_t> ArgCount{};
+
+				if (op_stack.back().m_Position == iOpenParen - 1)
+				{
+					ptrdiff_t iDepth = 0, iCommas = 0;
+
+					for (auto&& arg : tokens.subspan(iOpenParen + 1, i - iOpenParen - 1))
+					{
+						if (arg == "(")
+							++iDepth;
+						else if (arg == ")")
+							--iDepth;
+						else if (arg == "," && iDepth == 0)
+							++iCommas;
+					}
+
+					ArgCount = (uint8_t)std::min<ptrdiff_t>(i - iOpenParen > 1 ? iCommas + 1 : 0, std::numeric_limits<uint8_t>::max());
+				}
+
+				ret.push_back({ op_stack.back().m_Op, ArgCount });
 				op_stack.pop_back();
 			}
 		}
@@ -448,7 +464,7 @@ constexpr auto ShuntingYardAlgorithm(span<string_view const> tokens) noexcept ->
 		op_stack.pop_back();
 	}
 
-	return std::move(ret);	// For constructing expected<> object
+	return {};
 }
 
 #pragma endregion Generic Parser
@@ -529,38 +545,292 @@ enum struct EAssociativity : bool
 
 namespace DynExpr
 {
+	// Everything an expression can evaluate to. Keep the order in sync with EValueType.
+	using value_t = std::variant<std::monostate, double, Vector, Vector2D, bool>;
+
+	enum struct EValueType : uint8_t
+	{
+		Void,
+		Number,
+		Vector3,
+		Vector2,
+		Boolean,
+	};
+
+	template <typename T, typename... Tys>
+	consteval EValueType TypeOfImpl(std::variant<Tys...> const*) noexcept
+	{
+		uint8_t i = 0;
+		((std::same_as<T, Tys> ? false : (++i, true)) && ...);
+		return static_cast<EValueType>(i);
+	}
+
+	template <typename T>
+	inline constexpr EValueType TypeOf = std::same_as<T, void> ? EValueType::Void : TypeOfImpl<T>(static_cast<value_t const*>(nullptr));
+
+	static_assert(TypeOf<double> == EValueType::Number && TypeOf<bool> == EValueType::Boolean);
+
+	constexpr auto TypeName(EValueType type) noexcept -> string_view
+	{
+		switch (type)
+		{
+		case EValueType::Void:		return "void";
+		case EValueType::Number:	return "double";
+		case EValueType::Vector3:	return "Vector";
+		case EValueType::Vector2:	return "Vector2D";
+		case EValueType::Boolean:	return "bool";
+		default:					return "<corrupted>";
+		}
+	}
+
+	constexpr auto TypeOfValue(value_t const& v) noexcept { return static_cast<EValueType>(v.index()); }
+
+	// Normalize all arithmetic types into double
+	template <typename T>
+	using normalized_t = std::conditional_t<std::is_arithmetic_v<std::remove_cvref_t<T>> && !std::same_as<std::remove_cvref_t<T>, bool>, double, std::remove_cvref_t<T>>;
+
+	template <typename T>
+	__forceinline decltype(auto) Arg(value_t const& v) noexcept
+	{
+		// Type had been verified by the caller.
+		return *std::get_if<normalized_t<T>>(&v);
+	}
+
+	// Fixed capacity, no allocation. Compile() rejects anything deeper.
+	// Slots are left uninitialized, since every evaluation brings up a stack of its own.
+	struct value_stack_t final
+	{
+		static inline constexpr ptrdiff_t CAPACITY = 64;
+		static_assert(std::is_trivially_copyable_v<value_t> && std::is_trivially_destructible_v<value_t>);
+
+		constexpr value_stack_t() noexcept {}
+		constexpr ~value_stack_t() noexcept {}
+
+		union { value_t m_Values[CAPACITY]; };
+		ptrdiff_t m_iSize{};
+
+		constexpr auto size() const noexcept { return m_iSize; }
+		constexpr bool empty() const noexcept { return m_iSize == 0; }
+		constexpr void clear() noexcept { m_iSize = 0; }
+		constexpr auto back() const noexcept -> value_t const& { return m_Values[m_iSize - 1]; }
+		constexpr auto top(ptrdiff_t n) const noexcept -> span<value_t const> { return { &m_Values[m_iSize - n], (size_t)n }; }
+		constexpr void pop(ptrdiff_t n = 1) noexcept { m_iSize -= n; }
+		constexpr void push(value_t const& v) noexcept { std::construct_at(&m_Values[m_iSize++], v); }
+		constexpr void replace_top(value_t const& v) noexcept { std::construct_at(&m_Values[m_iSize - 1], v); }
+	};
+
+	// One value_stack_t per lane, side by side. Shallow programs get more lanes out of the same storage.
+	struct batch_stack_t final
+	{
+		static inline constexpr ptrdiff_t SLOTS = value_stack_t::CAPACITY * 16;
+
+		constexpr batch_stack_t() noexcept {}
+		constexpr ~batch_stack_t() noexcept {}
+
+		union { value_t m_Values[SLOTS]; };
+	};
+
+	// Every name DynExpr knows of is interned here once, and its dense ID indexes the tables below.
+	// Open addressing with linear probing. Looking up never inserts.
+	struct symbol_pool_t final
+	{
+		static inline constexpr uint32_t NPOS = std::numeric_limits<uint32_t>::max();
+
+		vector<string_view> m_Names{};
+		vector<uint32_t> m_Buckets{};	// ID + 1, or zero if vacant. Size is always a power of two.
+
+		static constexpr auto Hash(string_view s) noexcept -> uint32_t
+		{
+			// FNV-1a
+			uint32_t ret = 2166136261u;
+
+			for (auto c : s)
+				ret = (ret ^ bit_cast<uint8_t>(c)) * 16777619u;
+
+			return ret;
+		}
+
+		auto Find(string_view s) const noexcept -> uint32_t
+		{
+			if (m_Buckets.empty())
+				return NPOS;
+
+			auto const mask = m_Buckets.size() - 1;
+
+			for (auto i = Hash(s) & mask; m_Buckets[i]; i = (i + 1) & mask)
+			{
+				if (m_Names[m_Buckets[i] - 1] == s)
+					return m_Buckets[i] - 1;
+			}
+
+			return NPOS;
+		}
+
+		auto Intern(string_view s) noexcept -> uint32_t
+		{
+			if (auto const id = Find(s); id != NPOS)
+				return id;
+
+			auto const id = (uint32_t)m_Names.size();
+			m_Names.emplace_back(s);
+
+			// Keep the load factor under a half, so a miss ends at a vacancy soon.
+			if (m_Names.size() * 2 > m_Buckets.size())
+			{
+				m_Buckets.assign(std::max<size_t>(m_Buckets.size() * 2, 64), 0);
+
+				for (uint32_t i = 0; i < m_Names.size(); ++i)
+					Place(i);
+			}
+			else
+				Place(id);
+
+			return id;
+		}
+
+		void Place(uint32_t id) noexcept
+		{
+			auto const mask = m_Buckets.size() - 1;
+			auto i = Hash(m_Names[id]) & mask;
+
+			while (m_Buckets[i])
+				i = (i + 1) & mask;
+
+			m_Buckets[i] = id + 1;
+		}
+	};
+
+	inline symbol_pool_t m_Symbols{};
+
+	// Data of one kind attached to interned names, indexed by their ID.
+	// Only bind() inserts, which is for binders. Everything else uses find().
+	template <typename V>
+	struct symbol_table_t final
+	{
+		vector<optional<V>> m_Entries{};
+		size_t m_iCount{};
+
+		auto find(uint32_t id) noexcept -> V* { return id < m_Entries.size() && m_Entries[id] ? &*m_Entries[id] : nullptr; }
+		auto find(uint32_t id) const noexcept -> V const* { return id < m_Entries.size() && m_Entries[id] ? &*m_Entries[id] : nullptr; }
+		auto find(string_view s) noexcept -> V* { return find(m_Symbols.Find(s)); }
+		auto find(string_view s) const noexcept -> V const* { return find(m_Symbols.Find(s)); }
+		bool contains(string_view s) const noexcept { return find(s) != nullptr; }
+		auto size() const noexcept { return m_iCount; }
+
+		auto bind(string_view s) noexcept -> V&
+		{
+			auto const id = m_Symbols.Intern(s);
+
+			if (id >= m_Entries.size())
+				m_Entries.resize(id + 1);
+
+			if (!m_Entries[id])
+			{
+				m_Entries[id].emplace();
+				++m_iCount;
+			}
+
+			return *m_Entries[id];
+		}
+
+		auto keys() const noexcept
+		{
+			return std::views::iota(size_t{}, m_Entries.size())
+				| std::views::filter([this](size_t id) noexcept { return m_Entries[id].has_value(); })
+				| std::views::transform([](size_t id) noexcept { return m_Symbols.m_Names[id]; });
+		}
+	};
+
+	// Operator names, so the tokenizer can turn down a long candidate after a character or two instead of hashing all of it.
+	struct op_trie_t final
+	{
+		struct node_t final
+		{
+			vector<pair<char, uint32_t>> m_Edges{};
+			uint32_t m_iSymbol{ symbol_pool_t::NPOS };
+		};
+
+		vector<node_t> m_Nodes{ node_t{} };
+
+		void Insert(string_view s, uint32_t id) noexcept
+		{
+			uint32_t iNode = 0;
+
+			for (auto c : s)
+			{
+				auto const it = std::ranges::find(m_Nodes[iNode].m_Edges, c, &pair<char, uint32_t>::first);
+
+				if (it != m_Nodes[iNode].m_Edges.cend())
+					iNode = it->second;
+				else
+				{
+					m_Nodes[iNode].m_Edges.emplace_back(c, (uint32_t)m_Nodes.size());
+					iNode = (uint32_t)m_Nodes.size();
+					m_Nodes.emplace_back();
+				}
+			}
+
+			m_Nodes[iNode].m_iSymbol = id;
+		}
+
+		// Symbol ID of an exact match.
+		auto Find(string_view s) const noexcept -> uint32_t
+		{
+			uint32_t iNode = 0;
+
+			for (auto c : s)
+			{
+				auto const& Edges = m_Nodes[iNode].m_Edges;
+				auto const it = std::ranges::find(Edges, c, &pair<char, uint32_t>::first);
+
+				if (it == Edges.cend())
+					return symbol_pool_t::NPOS;
+
+				iNode = it->second;
+			}
+
+			return m_Nodes[iNode].m_iSymbol;
+		}
+	};
+
+	inline op_trie_t m_OpTrie{};
+
 	struct Function final
 	{
-		move_only_function<any(span<any>) const> m_callable{};	// #UPDATE_AT_CPP26 copyable_function
+		move_only_function<value_t(value_t const*) const> m_callable{};	// #UPDATE_AT_CPP26 copyable_function
 		ptrdiff_t m_iParamCount{};
-		vector<type_info const*> m_ParamTypes{};
+		vector<EValueType> m_ParamTypes{};
+		EValueType m_ReturnType{ EValueType::Void };
 		EAssociativity m_Associativity{ EAssociativity::Left };
 		uint8_t m_OpPrecedence{ OpPrec_FunctionCall };
+		bool m_bPure{ true };	// Same arguments always give the same result, hence a call with known arguments can be folded.
 	};
 
-	inline map<string_view, vector<Function>, std::ranges::less> m_Functions{};
-	inline vector<any> m_Stack{};
+	inline symbol_table_t<vector<Function>> m_Functions{};
 
 	template <typename R, typename... Params>
 	auto BindFunction(string_view szName, R(*pfn)(Params...)) noexcept -> Function&
 	{
-		return m_Functions[szName].emplace_back(
-			[pfn](span<any> params) -> any
+		static_assert(((TypeOf<normalized_t<Params>> != EValueType::Void) && ...), "Parameter type cannot be expressed in DynExpr");
+
+		return m_Functions.bind(szName).emplace_back(
+			[pfn](value_t const* params) -> value_t
 			{
-				return[&]<size_t... I>(std::index_sequence<I...>) -> any
+				return[&]<size_t... I>(std::index_sequence<I...>) -> value_t
 				{
 					if constexpr (std::same_as<R, void>)
 					{
-						pfn(any_cast<Params&&>(std::move(params[I]))...);
+						pfn(Arg<Params>(params[I])...);
 						return {};
 					}
 					else
-						return pfn(any_cast<Params&&>(std::move(params[I]))...);
+						return static_cast<normalized_t<R>>(pfn(Arg<Params>(params[I])...));
 				}
 				(std::index_sequence_for<Params...>{});
 			},
 			(ptrdiff_t)sizeof...(Params),
-			decltype(Function::m_ParamTypes){ &typeid(Params)... }	// Explict template argument to support function with 0 arg.
+			decltype(Function::m_ParamTypes){ TypeOf<normalized_t<Params>>... },	// Explict template argument to support function with 0 arg.
+			TypeOf<normalized_t<R>>
 		);
 	}
 
@@ -580,7 +850,10 @@ namespace DynExpr
 		Result.m_Associativity = Associativity;
 		Result.m_OpPrecedence = OpPrec;
 
-		for (auto&& FnBinder : m_Functions[szName])
+		auto& OverloadSet = *m_Functions.find(szName);
+		m_OpTrie.Insert(szName, m_Symbols.Find(szName));
+
+		for (auto&& FnBinder : OverloadSet)
 		{
 			if (FnBinder.m_iParamCount == Result.m_iParamCount &&
 				(FnBinder.m_Associativity != Associativity || FnBinder.m_OpPrecedence != OpPrec)) [[unlikely]]
@@ -593,162 +866,186 @@ namespace DynExpr
 			}
 		}
 
-		auto& OverloadSet = m_Functions[szName];
 		std::ranges::stable_sort(OverloadSet, std::ranges::greater{}, &Function::m_OpPrecedence);
 	}
 
-	inline map<string_view, any, std::ranges::less> m_Constants{
-		{ u8"e",	std::numbers::e		},
-		{ u8"ϕ",	std::numbers::phi	},
-		{ u8"phi",	std::numbers::phi	},
-		{ u8"π",	std::numbers::pi	},
-		{ u8"pi",	std::numbers::pi	},
-
-		// SI defining constants
-
-		{ u8"h",		6.62607015e-34	},	// Planck constant (ℎ/ℏ)
-		{ u8"e[0]",		1.602176634e-19	},	// Elementary charge
-		{ u8"k[B]",		1.380649e-23	},	// Boltzmann constant
-		{ u8"N[A]",		6.022'14076e23	},	// Avogadro constant
-		{ u8"c",		299'792'458		},	// Speed of light in vacuum
-		{ u8"ΔνCs",		9.192'631'770e9	},	// Unperturbed ground-state hyperfine transition frequency of the cesium-133 atom
-		{ u8"K[cd]",	683				},	// Luminous efficacy of monochromatic radiation of frequency 540×10^12 hertz
-
-		// Faraday constant			F
-		// Gravitational constant	G
-		// Conductance quantum		G[0]
-		// Molar gas constant		R
-		// Electron volt			eV
-		// Standard gravity			g
-		// Electron mass			m[e]
-		// Proton mass				m[p]
-		// Atomic mass constant		m[u]
-		// Electric constant		ε[0]
-		// Magnetic constant		μ[0]
-	};
+	// Constants live in slots, so a compiled program can refer to them by index.
+	// Unbinding empties the slot instead of erasing it, hence the index stays valid.
+	// A fixed slot never changes once bound, so the compiler may copy its value into the program.
+	inline vector<value_t> m_ConstantValues{};
+	inline vector<bool> m_ConstantFixed{};
+	inline symbol_table_t<size_t> m_Constants{};
+
+	inline auto FindConstant(uint32_t iSymbol) noexcept -> value_t const*
+	{
+		if (auto const pIdx = m_Constants.find(iSymbol); pIdx && !std::holds_alternative<std::monostate>(m_ConstantValues[*pIdx]))
+			return &m_ConstantValues[*pIdx];
+
+		return nullptr;
+	}
 
 	template <typename T>
 	void BindConstant(string_view szName, auto&&... args) noexcept
 	{
+		auto const pIdx = m_Constants.find(szName);
+
+		if (pIdx && m_ConstantFixed[*pIdx]) [[unlikely]]
+		{
+			// Programs compiled earlier may have folded the old value.
+			assert(false);
+			return;
+		}
+
 		if constexpr (std::same_as<T, void> || sizeof...(args) == 0)
-			m_Constants.erase(szName);
+		{
+			if (pIdx)
+				m_ConstantValues[*pIdx] = std::monostate{};
+		}
 		else
-			m_Constants[szName].emplace<T>(std::forward<decltype(args)>(args)...);
+		{
+			size_t const idx = pIdx ? *pIdx : (m_Constants.bind(szName) = m_ConstantValues.size());
+
+			if (idx == m_ConstantValues.size())
+			{
+				m_ConstantValues.emplace_back();
+				m_ConstantFixed.emplace_back(false);
+			}
+
+			m_ConstantValues[idx].emplace<normalized_t<T>>(std::forward<decltype(args)>(args)...);
+		}
+	}
+
+	// Variables are not bound at all. Each evaluation reads them from a frame supplied by the caller,
+	// by the slot given here. They are numbers, which is all a QC event has to pass in.
+	inline symbol_table_t<size_t> m_Variables{};
+
+	inline auto DeclareVariable(string_view szName) noexcept -> size_t
+	{
+		if (auto const pSlot = m_Variables.find(szName))
+			return *pSlot;
+
+		auto const iSlot = m_Variables.size();
+		return m_Variables.bind(szName) = iSlot;
+	}
+
+	template <typename T>
+	void FixConstant(string_view szName, auto&&... args) noexcept
+	{
+		static_assert(!std::same_as<T, void> && sizeof...(args) > 0, "Fixed constant must have a value");
+
+		BindConstant<T>(szName, std::forward<decltype(args)>(args)...);
+		m_ConstantFixed[*m_Constants.find(szName)] = true;
 	}
 
 	struct ClassMem final
 	{
-		any m_PointerToMem{};
-		type_info const* m_ClassType{ &typeid(void) };
-		type_info const* m_ClassPointerType{ &typeid(void) };
+		move_only_function<value_t(value_t const&) const> m_Getter{};
+		EValueType m_ClassType{ EValueType::Void };
+		EValueType m_MemberType{ EValueType::Void };
 	};
 
-	inline map<string_view, vector<ClassMem>, std::ranges::less> m_ClassMembers{};
+	inline symbol_table_t<vector<ClassMem>> m_ClassMembers{};
 
 	template <typename T, class C>
 	void BindMember(string_view szName, T C::* pMem) noexcept
 	{
-		m_ClassMembers[szName].emplace_back(
-			any{ std::in_place_type<decltype(pMem)>, pMem },
-			&typeid(C),
-			&typeid(C*)
-		);
+		static_assert(TypeOf<C> != EValueType::Void && TypeOf<normalized_t<T>> != EValueType::Void, "Member cannot be expressed in DynExpr");
 
-		// Avoid repeat register
-		static map<type_info const*, set<type_info const*, std::ranges::less>, std::ranges::less>
-			m_SupportedClasses{};
+		m_ClassMembers.bind(szName).emplace_back(
+			[pMem](value_t const& object) -> value_t { return static_cast<normalized_t<T>>(std::invoke(pMem, *std::get_if<C>(&object))); },
+			TypeOf<C>,
+			TypeOf<normalized_t<T>>
+		);
 
-		// Automatically list '*' as deref operator for this class.
-		// Must put before '.' and '->' because they are going to create the class map.
-		if (!m_SupportedClasses.contains(&typeid(C)))
+		// Member access is fused with its operand when compiling, this entry only tells the parser how '.' binds.
+		if (!m_Functions.contains("."))
 		{
-			BindOperator(
-				"*", EAssociativity::Right, OpPrec_Indirection,
-				+[](C* object) noexcept -> C { return std::move(*object); }
-			);
-		}
+			auto& Syntax = m_Functions.bind(".").emplace_back();
+			Syntax.m_iParamCount = 2;
+			Syntax.m_ParamTypes = { EValueType::Void, EValueType::Void };
+			Syntax.m_Associativity = EAssociativity::Left;
+			Syntax.m_OpPrecedence = OpPrec_MemberAccess;
 
-		// Automatically list '.' as member accessing operator for this class.
-		if (!m_SupportedClasses[&typeid(C)].contains(&typeid(T)))
-		{
-			BindOperator(
-				".", EAssociativity::Left, OpPrec_MemberAccess,
-				// Normalize all arithmetic types into double
-				+[](C object, T C::* ptm) noexcept -> std::conditional_t<std::is_arithmetic_v<T>, double, T> { return std::invoke(ptm, object); }
-			);
-			BindOperator(
-				"->", EAssociativity::Left, OpPrec_MemberAccess,
-				// Normalize all arithmetic types into double
-				+[](C* object, T C::* ptm) noexcept -> std::conditional_t<std::is_arithmetic_v<T>, double, T> { return std::invoke(ptm, *object); }
-			);
-			m_SupportedClasses[&typeid(C)].emplace(&typeid(T));
+			m_OpTrie.Insert(".", m_Symbols.Find("."));
 		}
 	}
 
 	template <class C, typename R, typename... Params>
 	auto BindMethod(string_view szName, R(C::* pfn)(Params...) const) noexcept -> Function&
 	{
-		m_Functions[szName].push_back(
+		static_assert(TypeOf<C> != EValueType::Void && ((TypeOf<normalized_t<Params>> != EValueType::Void) && ...), "Method cannot be expressed in DynExpr");
+
+		auto& OverloadSet = m_Functions.bind(szName);
+
+		OverloadSet.push_back(
 			Function {
-				[pfn](span<any> args) -> any
+				[pfn](value_t const* args) -> value_t
 				{
-					return[&]<size_t... I>(std::index_sequence<I...>) -> any
+					return[&]<size_t... I>(std::index_sequence<I...>) -> value_t
 					{
 						if constexpr (std::same_as<R, void>)
 						{
-							std::invoke(pfn, any_cast<C&&>(std::move(args[0])), any_cast<Params&&>(std::move(args[1 + I]))...);
+							std::invoke(pfn, Arg<C>(args[0]), Arg<Params>(args[1 + I])...);
 							return {};
 						}
 						else
-							return std::invoke(pfn, any_cast<C&&>(std::move(args[0])), any_cast<Params&&>(std::move(args[1 + I]))...);
+							return static_cast<normalized_t<R>>(std::invoke(pfn, Arg<C>(args[0]), Arg<Params>(args[1 + I])...));
 					}
 					(std::index_sequence_for<Params...>{});
 				},
 				(ptrdiff_t)sizeof...(Params) + 1,
-				decltype(Function::m_ParamTypes){ &typeid(C), &typeid(Params)... }
+				decltype(Function::m_ParamTypes){ TypeOf<C>, TypeOf<normalized_t<Params>>... },
+				TypeOf<normalized_t<R>>
 			}
 		);
 
-		return m_Functions[szName].back();
+		return OverloadSet.back();
 	}
 
-	void Call(token_t token)
+	// Pick the overload for a call site, given the types that will be on the stack by then.
+	inline auto Resolve(vector<Function> const& overloads, token_t const& token, span<EValueType const> TypeStack) noexcept -> expected<Function const*, string>
 	{
-		bool bCalled = false;
-		string szErrMsg{};
+		// Only the last rejection gets reported. Keep the facts and format it once we know we are failing.
+		enum struct EReject : uint8_t { None, OperandCount, ArgumentCount, ArgumentType };
+
+		EReject Reject{};
+		Function const* pRejected{};
+		size_t iReceived{};
+		EValueType Arg{}, Param{};
 
-		auto&& overloads = m_Functions.at(token.m_Symbol);
 		for (auto&& func : overloads)
 		{
-			// Filter by operand, if it's an operator.
+			// Filter by operand, if it's an operator. Or by argument, if it's a function call.
 			if (token.m_OperandCount)
 			{
 				if (token.m_OperandCount != func.m_iParamCount)
 				{
-					szErrMsg =
-						std::format("Operator resolution failed: expected {:x} operand(s) but {} received.", *token.m_OperandCount, func.m_iParamCount);
+					Reject = EReject::OperandCount;
+					pRejected = &func;
 					continue;
 				}
 			}
 
-			auto&& bgn = std::ranges::prev(
-				m_Stack.end(),
-				std::ranges::min(std::ssize(m_Stack), func.m_iParamCount)
-			);
-			span const args{ bgn, m_Stack.end() };
+			auto const args = TypeStack.last(std::ranges::min(std::ssize(TypeStack), func.m_iParamCount));
 
 			if (std::ssize(args) != func.m_iParamCount)
 			{
-				szErrMsg = std::format("Function '{}' expecting {} parameters, but {} arguments received.", token.m_Symbol, func.m_iParamCount, args.size());
+				Reject = EReject::ArgumentCount;
+				pRejected = &func;
+				iReceived = args.size();
 				continue;
 			}
 
 			bool bResolved = true;
-			for (int i{}; auto&& [arg, param] : std::views::zip(args, func.m_ParamTypes))
+			for (size_t i{}; auto&& [arg, param] : std::views::zip(args, func.m_ParamTypes))
 			{
-				if (type_index(arg.type()) != *param)
+				if (arg != param)
 				{
-					szErrMsg = std::format("Type of argument #{} ('{}') mismatch with its parameter type ('{}')", i, arg.type().name(), param->name());
+					Reject = EReject::ArgumentType;
+					pRejected = &func;
+					iReceived = i;
+					Arg = arg;
+					Param = param;
 					bResolved = false;
 					break;
 				}
@@ -759,73 +1056,35 @@ namespace DynExpr
 			if (!bResolved)
 				continue;
 
-			bCalled = true;
-
-			auto&& res = func.m_callable(args);
-			m_Stack.erase(bgn, m_Stack.end());
-
-			if (res.has_value())
-				m_Stack.emplace_back(std::move(res));
-
-			break;
+			return &func;
 		}
 
-		if (!bCalled)
-			throw std::runtime_error{ szErrMsg };
-	}
-
-	template <typename T>
-	decltype(auto) Push(auto&&... what)
-	{
-		return m_Stack.emplace_back(
-			std::in_place_type<T>,
-			std::forward<decltype(what)>(what)...
-		);
-	}
-
-	bool TryPushConst(string_view szName) noexcept
-	{
-		if (auto const it = m_Constants.find(szName); it != m_Constants.cend())
+		switch (Reject)
 		{
-			m_Stack.emplace_back(it->second);
-			return true;
-		}
+		case EReject::OperandCount:
+			return std::unexpected(pRejected->m_OpPrecedence == OpPrec_FunctionCall ?
+				std::format("Function '{}' expecting {} parameters, but {} arguments received.", token.m_Symbol, pRejected->m_iParamCount, *token.m_OperandCount) :
+				std::format("Operator resolution failed: expected {:x} operand(s) but {} received.", *token.m_OperandCount, pRejected->m_iParamCount));
 
-		return false;
-	}
+		case EReject::ArgumentCount:
+			return std::unexpected(std::format("Function '{}' expecting {} parameters, but {} arguments received.", token.m_Symbol, pRejected->m_iParamCount, iReceived));
 
-	bool TryPushMem(string_view szName) noexcept
-	{
-		// There could be multiple member named the same.
-		if (auto const it = m_ClassMembers.find(szName);
-			it != m_ClassMembers.cend() && !m_Stack.empty())
-		{
-			auto const& ClassMems = it->second;
-			for (auto&& MemInfo : ClassMems)
-			{
-				// The object must match the type from member info. 'cause it's a ptr to class.
-				if (m_Stack.back().type() != *MemInfo.m_ClassType
-					&& m_Stack.back().type() != *MemInfo.m_ClassPointerType)
-					continue;
-
-				m_Stack.push_back(MemInfo.m_PointerToMem);
-				return true;
-			}
+		case EReject::ArgumentType:
+			return std::unexpected(std::format("Type of argument #{} ('{}') mismatch with its parameter type ('{}')", iReceived, TypeName(Arg), TypeName(Param)));
 
-			return false;
+		default:
+			return std::unexpected(string{});
 		}
-
-		return false;
 	}
 
-	auto PushLiteral(string_view s) noexcept -> expected<any*, string>
+	inline auto ParseLiteral(string_view s) noexcept -> expected<value_t, string>
 	{
 		if (s.empty())
 			return std::unexpected("Empty token");
 
 		// String literal
 		if (s.front() == '"' && s.back() == '"' && s.size() >= 2)
-			return &Push<string_view>(s.substr(1, s.size() - 2));
+			return std::unexpected(std::format("String literal {} cannot be used as a value", s));
 		if (s.front() == '\'' && s.back() == '\'')
 		{
 			if (s.size() == 2)
@@ -841,7 +1100,7 @@ namespace DynExpr
 				if (s.size() != std::to_underlying(CP) + 2)
 					return std::unexpected(std::format("Bad UTF-8 encoding. {} bytes expected but {} found.", std::to_underlying(CP), s.size() - 2));
 				
-				return &Push<u32char>(UTIL_ToFullWidth({ &s[1], std::to_underlying(CP) }));
+				return (double)UTIL_ToFullWidth({ &s[1], std::to_underlying(CP) });	// Character is its code point.
 
 			default:
 				return std::unexpected("Corrupted UTF-8 encoding.");
@@ -864,30 +1123,18 @@ namespace DynExpr
 		{
 			uint32_t ret{};	// Plus 2 to skip the 0* part
 			if (std::from_chars(s.data() + 2, s.data() + s.size(), ret, base).ec == std::errc{})
-				return &Push<double>((double)ret);
+				return (double)ret;
 
 			return std::unexpected(std::format("Fail to interpret Base{} number '{}'", base, s));
 		}
 
 		double ret{};
 		if (std::from_chars(s.data(), s.data() + s.size(), ret).ec == std::errc{})
-			return &Push<double>(ret);
+			return ret;
 
 		return std::unexpected(std::format("Fail to interpret assumed-number '{}'", s));
 	}
 
-	template <typename T>
-	T Pop() noexcept
-	{
-		auto out = std::move(m_Stack.back());
-		m_Stack.pop_back();
-
-		if constexpr (std::same_as<T, any>)
-			return std::move(out);
-		else
-			return any_cast<T&&>(std::move(out));
-	}
-
 	//
 
 	constexpr bool IsIdentifier(string_view s) noexcept
@@ -942,13 +1189,17 @@ namespace DynExpr
 		if (s.empty())	// What? only a sign was passed in?
 			return false;
 
-		// Is IRL constant?
+		// Is IRL constant or variable?
 		if not consteval
 		{
-			if (m_Constants.contains(s))
+			if (auto const iSymbol = m_Symbols.Find(s); FindConstant(iSymbol) || m_Variables.find(iSymbol))
 				return true;
 		}
 
+		// Whatever is left must be a number. Don't bother counting digits on anything else.
+		if (!('0' <= s.front() && s.front() <= '9'))
+			return false;
+
 		bool const bHex = s.starts_with("0x") || s.starts_with("0X");
 		bool const bOct = s.starts_with("0o") || s.starts_with("0O");
 		bool const bBin = s.starts_with("0b") || s.starts_with("0B");
@@ -1004,11 +1255,11 @@ namespace DynExpr
 		return s == ")";
 	}
 
-	bool IsFunction(string_view s) noexcept	// Will exclude operators.
+	inline bool IsFunction(string_view s) noexcept	// Will exclude operators.
 	{
-		if (auto const it = m_Functions.find(s); it != m_Functions.cend())
+		if (auto const pOverloads = m_Functions.find(s))
 		{
-			for (auto&& FnBinder : it->second)
+			for (auto&& FnBinder : *pOverloads)
 			{
 				if (FnBinder.m_OpPrecedence != OpPrec_FunctionCall)
 					return false;
@@ -1020,11 +1271,12 @@ namespace DynExpr
 		return false;
 	}
 
-	bool IsOperator(string_view s) noexcept
+	inline bool IsOperator(string_view s) noexcept
 	{
-		if (auto const it = m_Functions.find(s); it != m_Functions.cend())
+		// Every operator is in the trie, which turns most of the tokenizer's probes down within a character.
+		if (auto const pOverloads = m_Functions.find(m_OpTrie.Find(s)))
 		{
-			for (auto&& FnBinder : it->second)
+			for (auto&& FnBinder : *pOverloads)
 			{
 				if (FnBinder.m_OpPrecedence == OpPrec_FunctionCall)
 					return false;
@@ -1036,7 +1288,7 @@ namespace DynExpr
 		return false;
 	}
 
-	optional<uint8_t> GetOperandCount(op_context_t const& OpContext, span<string_view const> tokens) noexcept
+	inline optional<uint8_t> GetOperandCount(op_context_t const& OpContext, span<string_view const> tokens) noexcept
 	{
 		if (!IsOperator(OpContext.m_Op))
 			return std::nullopt;
@@ -1074,7 +1326,7 @@ namespace DynExpr
 			{
 				if (IsOperator(tokens[i]))
 				{
-					auto const& OverloadSet = m_Functions[tokens[i]];
+					auto const& OverloadSet = *m_Functions.find(tokens[i]);
 					for (auto&& Candidate : OverloadSet)
 					{
 						// Has a potential to function as unary op is enough.
@@ -1107,7 +1359,7 @@ namespace DynExpr
 			{
 				if (IsOperator(tokens[i]))
 				{
-					auto const& OverloadSet = m_Functions[tokens[i]];
+					auto const& OverloadSet = *m_Functions.find(tokens[i]);
 					for (auto&& Candidate : OverloadSet)
 					{
 						// Has a potential to function as unary op is enough.
@@ -1131,14 +1383,14 @@ namespace DynExpr
 		return ret;
 	}
 
-	optional<bool> IsLeftAssociative(op_context_t const& OpContext, span<string_view const> tokens) noexcept
+	inline optional<bool> IsLeftAssociative(op_context_t const& OpContext, span<string_view const> tokens) noexcept
 	{
 		auto const iOperandCount = GetOperandCount(OpContext, tokens);
 
-		if (auto const it = m_Functions.find(OpContext.m_Op); it != m_Functions.cend())
+		if (auto const pOverloads = m_Functions.find(OpContext.m_Op))
 		{
 			// Assume the overload set is sorted by precedence.
-			auto const& OverloadSet = it->second;
+			auto const& OverloadSet = *pOverloads;
 
 			for (auto&& Candidate : OverloadSet)
 			{
@@ -1151,14 +1403,14 @@ namespace DynExpr
 		return std::nullopt;
 	}
 
-	optional<uint8_t> GetOpPrecedence(op_context_t const& OpContext, span<string_view const> tokens) noexcept
+	inline optional<uint8_t> GetOpPrecedence(op_context_t const& OpContext, span<string_view const> tokens) noexcept
 	{
 		auto const iOperandCount = GetOperandCount(OpContext, tokens);
 
-		if (auto const it = m_Functions.find(OpContext.m_Op); it != m_Functions.cend())
+		if (auto const pOverloads = m_Functions.find(OpContext.m_Op))
 		{
 			// Assume the overload set is sorted by precedence.
-			auto const& OverloadSet = it->second;
+			auto const& OverloadSet = *pOverloads;
 
 			for (auto&& Candidate : OverloadSet)
 			{
@@ -1171,7 +1423,7 @@ namespace DynExpr
 		return std::nullopt;
 	}
 
-	__forceinline auto Tokenizer(string_view const& s) noexcept
+	__forceinline auto Tokenizer(string_view const& s, vector<string_view>& ret) noexcept
 	{
 		return
 			::Tokenizer<
@@ -1179,10 +1431,10 @@ namespace DynExpr
 				[](string_view s, bool b) noexcept { return (IsIdentifier(s) && !IsOperator(s)) || IsLiteral(s, b); },
 				[](string_view s) noexcept { return IsOpenBracket(s) || IsCloseBracket(s); },
 				&IsOperator
-			>(s, " \t\f\v\r\n");
+			>(s, ret, " \t\f\v\r\n");
 	}
 
-	__forceinline auto ShuntingYardAlgorithm(span<string_view const> tokens) noexcept
+	__forceinline auto ShuntingYardAlgorithm(span<string_view const> tokens, vector<token_t>& ret, vector<op_context_t>& op_stack) noexcept
 	{
 		return
 			::ShuntingYardAlgorithm<
@@ -1193,45 +1445,491 @@ namespace DynExpr
 				&IsLeftAssociative,
 				&GetOpPrecedence,
 				&GetOperandCount
-			>(tokens);
+			>(tokens, ret, op_stack);
 	}
 
 	//
 
-	template <typename T>
-	auto Execute(span<token_t const> Instructions) noexcept -> expected<T, string>
+	// Compiled form: everything Execute() used to look up per token is resolved once,
+	// including overloads, which are picked by inferring the type of every stack slot.
+	// Hence, all functions, operators and members must be bound before anything is compiled.
+
+	enum struct EOpCode : uint8_t
+	{
+		PushLiteral,	// m_iIndex into Program::m_Literals
+		PushConst,		// m_iIndex into m_ConstantValues, must still hold m_Type
+		PushVar,		// m_iIndex into the frame
+		GetMember,		// m_pMember, fused with the following '.'
+		Call,			// m_pFunction
+	};
+
+	struct instr_t final
 	{
-		m_Stack.clear();
+		EOpCode m_OpCode{};
+		EValueType m_Type{};		// What this instruction leaves on the stack.
+		uint16_t m_iSymbolPos{};	// Where the symbol is in the source, for diagnostics only.
+		uint16_t m_iSymbolLen{};
+		uint32_t m_iIndex{};
+		Function const* m_pFunction{};
+		ClassMem const* m_pMember{};
+	};
 
-		try
+	// QC event options are 64 bytes at most.
+	inline constexpr size_t MAX_EXPR_LENGTH = 256;
+	static_assert(MAX_EXPR_LENGTH <= std::numeric_limits<uint16_t>::max(), "Symbol positions are 16 bits");
+
+	struct Program final
+	{
+		string m_Source{};
+		vector<instr_t> m_Instructions{};
+		vector<value_t> m_Literals{};
+		EValueType m_ResultType{};
+		size_t m_iUnfoldedSize{};	// Instruction count before folding.
+		size_t m_iFrameSize{};		// Variables the caller must supply.
+		size_t m_iMaxDepth{};		// Deepest the stack gets. Folding never makes it deeper.
+
+		constexpr auto SymbolOf(instr_t const& ins) const noexcept -> string_view
 		{
-			for (auto&& token : Instructions)
+			return string_view{ m_Source }.substr(ins.m_iSymbolPos, ins.m_iSymbolLen);
+		}
+	};
+
+	// Caret-style message pointing at the offending token.
+	inline auto Diagnose(string_view src, span<string_view const> tokens, string_view symbol, string msg) noexcept -> string
+	{
+		error_t err{ src, tokens, std::move(msg) };
+
+		if (auto const it = std::ranges::find(tokens, symbol.data(), &string_view::data); it != tokens.end())
+			err.Emphasis(std::ranges::distance(tokens.begin(), it));
+
+		return std::format("{}\n{}", err.m_ErrorMsg, err.ToString());
+	}
+
+	struct fold_slot_t final
+	{
+		size_t m_iFirstInstr{};		// Where the instructions computing this slot begin in the output.
+		optional<value_t> m_Value{};
+	};
+
+	// Scratch space of Compile(). Only ever grows, so compiling stops allocating once it has seen the longest expression.
+	struct arena_t final
+	{
+		vector<string_view> m_Tokens{};
+		vector<token_t> m_Rpn{};
+		vector<op_context_t> m_OpStack{};
+		vector<EValueType> m_TypeStack{};
+
+		vector<instr_t> m_FoldOutput{};
+		vector<value_t> m_FoldLiterals{};
+		vector<fold_slot_t> m_FoldSlots{};
+		vector<value_t> m_FoldArgs{};
+	};
+
+	inline arena_t m_Arena{};
+
+	// Replace every subexpression with a known value by a single literal.
+	// Known values are literals, fixed constants, members of known values and pure calls with known arguments.
+	inline void Fold(Program& prog, arena_t& Arena) noexcept
+	{
+		using slot_t = fold_slot_t;
+
+		auto& Output = Arena.m_FoldOutput;
+		auto& Literals = Arena.m_FoldLiterals;
+		auto& Slots = Arena.m_FoldSlots;
+
+		Output.clear();
+		Literals.clear();
+		Slots.clear();
+
+		Output.reserve(prog.m_Instructions.size());
+
+		auto const fnEmitLiteral = [&](instr_t ins, value_t const& val) noexcept
+		{
+			ins.m_OpCode = EOpCode::PushLiteral;
+			ins.m_Type = TypeOfValue(val);
+			ins.m_iIndex = (uint32_t)Literals.size();
+
+			Literals.emplace_back(val);
+			Output.emplace_back(ins);
+		};
+
+		for (auto&& ins : prog.m_Instructions)
+		{
+			auto const iFirst = Output.size();
+
+			switch (ins.m_OpCode)
 			{
-				if (token.m_Symbol == ",") {	// NOP
+			case EOpCode::PushLiteral:
+				fnEmitLiteral(ins, prog.m_Literals[ins.m_iIndex]);
+				Slots.emplace_back(iFirst, prog.m_Literals[ins.m_iIndex]);
+				break;
+
+			case EOpCode::PushConst:
+				if (m_ConstantFixed[ins.m_iIndex])
+				{
+					fnEmitLiteral(ins, m_ConstantValues[ins.m_iIndex]);
+					Slots.emplace_back(iFirst, m_ConstantValues[ins.m_iIndex]);
 				}
-				else if (TryPushMem(token.m_Symbol)) {
+				else
+				{
+					Output.emplace_back(ins);
+					Slots.emplace_back(iFirst, std::nullopt);
 				}
-				else if (TryPushConst(token.m_Symbol)) {
+				break;
+
+			case EOpCode::PushVar:
+				Output.emplace_back(ins);
+				Slots.emplace_back(iFirst, std::nullopt);
+				break;
+
+			case EOpCode::GetMember:
+				if (auto& Object = Slots.back(); Object.m_Value)
+				{
+					Object.m_Value = ins.m_pMember->m_Getter(*Object.m_Value);
+					Output.resize(Object.m_iFirstInstr);
+					fnEmitLiteral(ins, *Object.m_Value);
 				}
-				else if (IsLiteral(token.m_Symbol)) {
-					if (auto res = PushLiteral(token.m_Symbol); !res)
-						throw std::runtime_error{ std::move(res).error() };
+				else
+					Output.emplace_back(ins);
+				break;
+
+			case EOpCode::Call:
+			{
+				auto const args = span{ Slots }.last((size_t)ins.m_pFunction->m_iParamCount);
+				auto const iStart = args.empty() ? iFirst : args.front().m_iFirstInstr;
+				optional<value_t> Result{};
+
+				if (ins.m_pFunction->m_bPure && std::ranges::all_of(args, [](slot_t const& slot) noexcept { return slot.m_Value.has_value(); }))
+				{
+					auto& Values = Arena.m_FoldArgs;
+					Values.assign_range(args | std::views::transform([](slot_t const& slot) noexcept { return *slot.m_Value; }));
+
+					Result = ins.m_pFunction->m_callable(Values.data());
+					Output.resize(iStart);
+
+					if (ins.m_Type != EValueType::Void)
+						fnEmitLiteral(ins, *Result);
 				}
-				else if (IsFunction(token.m_Symbol) || IsOperator(token.m_Symbol))
-					Call(token);
 				else
-					throw std::runtime_error{ std::format("Unknow token '{}'", token.m_Symbol) };
+					Output.emplace_back(ins);
+
+				Slots.resize(Slots.size() - args.size());
+
+				if (ins.m_Type != EValueType::Void)
+					Slots.emplace_back(iStart, std::move(Result));
+
+				break;
+			}
+
+			default:
+				std::unreachable();
 			}
+		}
 
-			if (m_Stack.size() != 1)
-				throw std::runtime_error{ std::format("ESP corrpution detected, stack size == {}", m_Stack.size()) };
+		// Literals of folded subexpressions are dropped along with them.
+		// Folding never grows the program, so both fit in what the program already holds.
+		prog.m_Instructions.assign_range(Output);
+		prog.m_Literals.clear();
 
-			return Pop<T>();
+		for (auto&& ins : prog.m_Instructions)
+		{
+			if (ins.m_OpCode != EOpCode::PushLiteral)
+				continue;
+
+			prog.m_Literals.emplace_back(std::move(Literals[ins.m_iIndex]));
+			ins.m_iIndex = (uint32_t)(prog.m_Literals.size() - 1);
 		}
-		catch (const std::exception& e)
+	}
+
+	inline auto Compile(string_view szExpr, arena_t& Arena) noexcept -> expected<Program, string>
+	{
+		// Tokenizer tries every length at every position, keep junk input from stalling the server.
+		if (szExpr.size() > MAX_EXPR_LENGTH) [[unlikely]]
+			return std::unexpected(std::format("Expression too long: {} characters, {} at most", szExpr.size(), MAX_EXPR_LENGTH));
+
+		Program ret{ .m_Source{ string{ szExpr } } };
+		string_view const src{ ret.m_Source };	// Tokens must point into our own copy.
+
+		auto const& Tokens = Arena.m_Tokens;
+		if (auto const Result = Tokenizer(src, Arena.m_Tokens); !Result)
+			return std::unexpected(std::format("{}\n{}", Result.error().m_ErrorMsg, Result.error().ToString()));
+
+		auto const& Instructions = Arena.m_Rpn;
+		if (auto const Result = ShuntingYardAlgorithm(Tokens, Arena.m_Rpn, Arena.m_OpStack); !Result)
+			return std::unexpected(Result.error());
+
+		ret.m_Instructions.reserve(Instructions.size());
+
+		auto& TypeStack = Arena.m_TypeStack;
+		TypeStack.clear();
+		auto const fnError = [&](string_view symbol, string msg) noexcept { return std::unexpected(Diagnose(src, Tokens, symbol, std::move(msg))); };
+
+		for (auto it = Instructions.cbegin(); it != Instructions.cend(); ++it)
 		{
-			return std::unexpected(e.what());
+			auto&& token = *it;
+
+			instr_t ins{
+				.m_iSymbolPos{ (uint16_t)(token.m_Symbol.data() - src.data()) },
+				.m_iSymbolLen{ (uint16_t)token.m_Symbol.size() },
+			};
+
+			if (token.m_Symbol == ",")
+				continue;	// NOP
+
+			// Hashed once, every table below is then indexed by the ID.
+			auto const iSymbol = m_Symbols.Find(token.m_Symbol);
+
+			if (auto const pMembers = m_ClassMembers.find(iSymbol))
+			{
+				// The member name is always the right operand of '.', hence it comes right before it in RPN.
+				if (std::ranges::next(it) == Instructions.cend() || std::ranges::next(it)->m_Symbol != ".")
+					return fnError(token.m_Symbol, std::format("Unknow token '{}'", token.m_Symbol));
+
+				auto const pMember = TypeStack.empty() ? pMembers->cend() : std::ranges::find(*pMembers, TypeStack.back(), &ClassMem::m_ClassType);
+				if (pMember == pMembers->cend())
+					return fnError(token.m_Symbol, std::format("No member '{}' in type '{}'", token.m_Symbol, TypeName(TypeStack.empty() ? EValueType::Void : TypeStack.back())));
+
+				ins.m_OpCode = EOpCode::GetMember;
+				ins.m_Type = pMember->m_MemberType;
+				ins.m_pMember = std::addressof(*pMember);
+				TypeStack.back() = ins.m_Type;
+				++it;	// Swallow the '.'
+			}
+			else if (auto const pSlot = m_Variables.find(iSymbol))
+			{
+				ins.m_OpCode = EOpCode::PushVar;
+				ins.m_Type = EValueType::Number;
+				ins.m_iIndex = (uint32_t)*pSlot;
+
+				ret.m_iFrameSize = std::max(ret.m_iFrameSize, *pSlot + 1);
+				TypeStack.push_back(ins.m_Type);
+			}
+			else if (auto const pIdx = m_Constants.find(iSymbol))
+			{
+				ins.m_OpCode = EOpCode::PushConst;
+				ins.m_Type = TypeOfValue(m_ConstantValues[*pIdx]);
+				ins.m_iIndex = (uint32_t)*pIdx;
+
+				if (ins.m_Type == EValueType::Void)
+					return fnError(token.m_Symbol, std::format("Unknow token '{}'", token.m_Symbol));
+
+				TypeStack.push_back(ins.m_Type);
+			}
+			else if (IsLiteral(token.m_Symbol))
+			{
+				auto res = ParseLiteral(token.m_Symbol);
+				if (!res)
+					return fnError(token.m_Symbol, std::move(res).error());
+
+				ins.m_OpCode = EOpCode::PushLiteral;
+				ins.m_Type = TypeOfValue(*res);
+				ins.m_iIndex = (uint32_t)ret.m_Literals.size();
+				ret.m_Literals.emplace_back(*std::move(res));
+				TypeStack.push_back(ins.m_Type);
+			}
+			else if (auto const pOverloads = m_Functions.find(iSymbol))
+			{
+				auto const pFunction = Resolve(*pOverloads, token, TypeStack);
+				if (!pFunction)
+					return fnError(token.m_Symbol, pFunction.error());
+
+				ins.m_OpCode = EOpCode::Call;
+				ins.m_Type = (*pFunction)->m_ReturnType;
+				ins.m_pFunction = *pFunction;
+
+				TypeStack.resize(TypeStack.size() - (size_t)ins.m_pFunction->m_iParamCount);
+				if (ins.m_Type != EValueType::Void)
+					TypeStack.push_back(ins.m_Type);
+			}
+			else
+				return fnError(token.m_Symbol, std::format("Unknow token '{}'", token.m_Symbol));
+
+			if (std::ssize(TypeStack) > value_stack_t::CAPACITY)
+				return fnError(token.m_Symbol, std::format("Stack overflow, expression deeper than {}", value_stack_t::CAPACITY));
+
+			ret.m_iMaxDepth = std::max(ret.m_iMaxDepth, TypeStack.size());
+			ret.m_Instructions.emplace_back(ins);
+		}
+
+		if (TypeStack.size() != 1)
+			return std::unexpected(std::format("ESP corrpution detected, stack size == {}", TypeStack.size()));
+
+		ret.m_ResultType = TypeStack.front();
+		ret.m_iUnfoldedSize = ret.m_Instructions.size();
+
+		Fold(ret, Arena);
+		return std::move(ret);
+	}
+
+	__forceinline auto Compile(string_view szExpr) noexcept
+	{
+		return Compile(szExpr, m_Arena);
+	}
+
+	// The stack lives in here and variables come from the frame, so nothing global is written.
+	// Evaluations may therefore nest or interleave freely.
+	template <typename T>
+	auto Execute(Program const& prog, span<double const> Frame = {}) noexcept -> expected<T, string>
+	{
+		if constexpr (!std::same_as<T, value_t>)
+		{
+			if (prog.m_ResultType != TypeOf<T>)
+				return std::unexpected(std::format("Expression yields '{}' but '{}' is expected", TypeName(prog.m_ResultType), TypeName(TypeOf<T>)));
 		}
+
+		if (Frame.size() < prog.m_iFrameSize) [[unlikely]]
+			return std::unexpected(std::format("Expression reads {} variable(s) but only {} supplied", prog.m_iFrameSize, Frame.size()));
+
+		value_stack_t Stack;
+
+		for (auto&& ins : prog.m_Instructions)
+		{
+			switch (ins.m_OpCode)
+			{
+			case EOpCode::PushLiteral:
+				Stack.push(prog.m_Literals[ins.m_iIndex]);
+				break;
+
+			case EOpCode::PushConst:
+				// Slot could be emptied or rebound to another type after we compiled.
+				if (TypeOfValue(m_ConstantValues[ins.m_iIndex]) != ins.m_Type) [[unlikely]]
+					return std::unexpected(std::format("Constant '{}' is no longer a '{}'", prog.SymbolOf(ins), TypeName(ins.m_Type)));
+
+				Stack.push(m_ConstantValues[ins.m_iIndex]);
+				break;
+
+			case EOpCode::PushVar:
+				Stack.push(Frame[ins.m_iIndex]);
+				break;
+
+			case EOpCode::GetMember:
+				Stack.replace_top(ins.m_pMember->m_Getter(Stack.back()));
+				break;
+
+			case EOpCode::Call:
+			{
+				auto const iParamCount = ins.m_pFunction->m_iParamCount;
+				auto res = ins.m_pFunction->m_callable(Stack.top(iParamCount).data());
+				Stack.pop(iParamCount);
+
+				if (ins.m_Type != EValueType::Void)
+					Stack.push(res);
+
+				break;
+			}
+
+			default:
+				std::unreachable();
+			}
+		}
+
+		if constexpr (std::same_as<T, value_t>)
+			return Stack.back();
+		else
+			return *std::get_if<T>(&Stack.back());
+	}
+
+	// Run the program over Out.size() elements at once, paying the dispatch once per instruction rather than once per element.
+	// Frames is in structure-of-arrays layout: variable #v of element #i is at Frames[v * Out.size() + i].
+	template <typename T>
+	auto ExecuteBatch(Program const& prog, span<double const> Frames, span<T> Out) noexcept -> expected<void, string>
+	{
+		if constexpr (!std::same_as<T, value_t>)
+		{
+			if (prog.m_ResultType != TypeOf<T>)
+				return std::unexpected(std::format("Expression yields '{}' but '{}' is expected", TypeName(prog.m_ResultType), TypeName(TypeOf<T>)));
+		}
+
+		auto const N = Out.size();
+
+		if (Frames.size() < prog.m_iFrameSize * N) [[unlikely]]
+			return std::unexpected(std::format("Expression reads {} variable(s) of {} element(s) but only {} values supplied", prog.m_iFrameSize, N, Frames.size()));
+
+		for (auto&& ins : prog.m_Instructions)
+		{
+			if (ins.m_OpCode == EOpCode::PushConst && TypeOfValue(m_ConstantValues[ins.m_iIndex]) != ins.m_Type) [[unlikely]]
+				return std::unexpected(std::format("Constant '{}' is no longer a '{}'", prog.SymbolOf(ins), TypeName(ins.m_Type)));
+		}
+
+		batch_stack_t Stack;
+
+		auto const iDepth = std::max<size_t>(prog.m_iMaxDepth, 1);
+		auto const iLanes = (size_t)batch_stack_t::SLOTS / iDepth;
+
+		for (size_t iBase = 0; iBase < N; iBase += iLanes)
+		{
+			auto const iCount = std::min(N - iBase, iLanes);
+			size_t iTop = 0;	// Same height on every lane.
+
+			auto const fnSlot = [&](size_t iLane, size_t iRow) noexcept { return &Stack.m_Values[iLane * iDepth + iRow]; };
+
+			for (auto&& ins : prog.m_Instructions)
+			{
+				switch (ins.m_OpCode)
+				{
+				case EOpCode::PushLiteral:
+					for (size_t i = 0; i < iCount; ++i)
+						std::construct_at(fnSlot(i, iTop), prog.m_Literals[ins.m_iIndex]);
+
+					++iTop;
+					break;
+
+				case EOpCode::PushConst:
+					for (size_t i = 0; i < iCount; ++i)
+						std::construct_at(fnSlot(i, iTop), m_ConstantValues[ins.m_iIndex]);
+
+					++iTop;
+					break;
+
+				case EOpCode::PushVar:
+				{
+					auto const pVar = &Frames[ins.m_iIndex * N + iBase];
+
+					for (size_t i = 0; i < iCount; ++i)
+						std::construct_at(fnSlot(i, iTop), pVar[i]);
+
+					++iTop;
+					break;
+				}
+
+				case EOpCode::GetMember:
+					for (size_t i = 0; i < iCount; ++i)
+						std::construct_at(fnSlot(i, iTop - 1), ins.m_pMember->m_Getter(*fnSlot(i, iTop - 1)));
+
+					break;
+
+				case EOpCode::Call:
+				{
+					auto const iParamCount = (size_t)ins.m_pFunction->m_iParamCount;
+					auto const iArgs = iTop - iParamCount;
+
+					for (size_t i = 0; i < iCount; ++i)
+					{
+						auto res = ins.m_pFunction->m_callable(fnSlot(i, iArgs));
+
+						if (ins.m_Type != EValueType::Void)
+							std::construct_at(fnSlot(i, iArgs), res);
+					}
+
+					iTop = iArgs + (ins.m_Type != EValueType::Void);
+					break;
+				}
+
+				default:
+					std::unreachable();
+				}
+			}
+
+			for (size_t i = 0; i < iCount; ++i)
+			{
+				if constexpr (std::same_as<T, value_t>)
+					Out[iBase + i] = *fnSlot(i, 0);
+				else
+					Out[iBase + i] = *std::get_if<T>(fnSlot(i, 0));
+			}
+		}
+
+		return {};
 	}
 }
 
@@ -0,0 +1,246 @@
+export module EffectPool;
+
+import std;
+
+
+
+export namespace EffectPool
+{
+	// Edicts ever handed to effects. Beyond this, the least important live effect is recycled.
+	inline constexpr std::size_t CAPACITY = 256;
+
+	inline constexpr std::uint16_t NPOS = std::numeric_limits<std::uint16_t>::max();
+
+	enum EBehaviour : std::uint8_t
+	{
+		FX_SPRITE_ONCE	= (1 << 0),	// Advance the sprite frame at m_flFPS, dies after the last frame.
+		FX_FADE_OUT		= (1 << 1),	// Lose m_flDecay alpha every frame while rolling and growing, dies at zero.
+		FX_TIME_OUT		= (1 << 2),	// Dies after m_flLifetime.
+		FX_SKIN_ANIM	= (1 << 3),	// Advance the skin at m_flFPS and hold the last one.
+	};
+
+	// Everything the tick needs to play an effect, without touching its edict.
+	struct desc_t
+	{
+		std::uint8_t m_iKind{};
+		std::uint8_t m_iPriority{};	// Higher survives eviction.
+		std::uint8_t m_bitsBehaviour{};
+		short m_iFrameCount{};	// Sprite frames or skins.
+		float m_flFPS{};
+		float m_flAlpha{};
+		float m_flDecay{};
+		float m_flRoll{};	// Per frame, along with the fading.
+		float m_flScale{};
+		float m_flScaleInc{};	// Extra scale reached at zero alpha.
+		float m_flLifetime{};
+	};
+
+	struct stats_t
+	{
+		std::size_t m_iSpawned{};
+		std::size_t m_iPeak{};
+		std::size_t m_iEvicted{};	// Live effect recycled for a more important one.
+		std::size_t m_iRejected{};	// Every live effect outranked the incoming one.
+	};
+
+	// Live effects are kept dense at the front of each array, so the tick is a straight walk.
+	// A handle names the edict an effect is using and stays put while the effect moves around.
+	struct pool_t
+	{
+		explicit pool_t(std::size_t iCapacity) noexcept
+			: m_Handle(iCapacity), m_Kind(iCapacity), m_Priority(iCapacity), m_Behaviour(iCapacity),
+			m_FrameCount(iCapacity), m_SpawnTime(iCapacity), m_DieTime(iCapacity), m_FPS(iCapacity),
+			m_Frame(iCapacity), m_Alpha(iCapacity), m_Decay(iCapacity), m_Roll(iCapacity), m_RollRate(iCapacity),
+			m_Scale(iCapacity), m_ScaleBase(iCapacity), m_ScaleInc(iCapacity), m_Dead(iCapacity),
+			m_PosOfHandle(iCapacity, NPOS)
+		{
+			m_FreeHandles.reserve(iCapacity);
+			m_Expired.reserve(iCapacity);
+		}
+
+		std::vector<std::uint16_t> m_Handle;
+		std::vector<std::uint8_t> m_Kind;
+		std::vector<std::uint8_t> m_Priority;
+		std::vector<std::uint8_t> m_Behaviour;
+		std::vector<short> m_FrameCount;
+		std::vector<float> m_SpawnTime;
+		std::vector<float> m_DieTime;
+		std::vector<float> m_FPS;
+		std::vector<float> m_Frame;
+		std::vector<float> m_Alpha;
+		std::vector<float> m_Decay;
+		std::vector<float> m_Roll;
+		std::vector<float> m_RollRate;
+		std::vector<float> m_Scale;
+		std::vector<float> m_ScaleBase;
+		std::vector<float> m_ScaleInc;
+		std::vector<std::uint8_t> m_Dead;
+
+		std::vector<std::uint16_t> m_PosOfHandle;
+		std::vector<std::uint16_t> m_FreeHandles{};
+		std::vector<std::uint16_t> m_Expired{};	// Handles freed by the last Tick(), their edicts need hiding.
+		std::size_t m_iLive{};
+		std::size_t m_iHandles{};	// Handles ever given out, i.e. edicts the caller has created.
+		stats_t m_Stats{};
+
+		[[nodiscard]] std::size_t Capacity() const noexcept { return m_Handle.size(); }
+
+		// Returns the handle playing this effect, or NPOS if nothing could be spared.
+		// A handle at or beyond the previous m_iHandles is new and needs its edict created.
+		std::uint16_t Acquire(desc_t const& Desc, float flTime) noexcept
+		{
+			std::size_t iPos{};
+			std::uint16_t iHandle{};
+
+			if (!m_FreeHandles.empty())
+			{
+				iHandle = m_FreeHandles.back();
+				m_FreeHandles.pop_back();
+				iPos = m_iLive++;
+			}
+			else if (m_iHandles < Capacity())
+			{
+				iHandle = (std::uint16_t)m_iHandles++;
+				iPos = m_iLive++;
+			}
+			else
+			{
+				// Full. The victim is the least important, then the oldest.
+				iPos = 0;
+
+				for (std::size_t i = 1; i < m_iLive; ++i)
+				{
+					if (std::tie(m_Priority[i], m_SpawnTime[i]) < std::tie(m_Priority[iPos], m_SpawnTime[iPos]))
+						iPos = i;
+				}
+
+				if (m_Priority[iPos] > Desc.m_iPriority)
+				{
+					++m_Stats.m_iRejected;
+					return NPOS;
+				}
+
+				iHandle = m_Handle[iPos];
+				++m_Stats.m_iEvicted;
+			}
+
+			m_Handle[iPos] = iHandle;
+			m_Kind[iPos] = Desc.m_iKind;
+			m_Priority[iPos] = Desc.m_iPriority;
+			m_Behaviour[iPos] = Desc.m_bitsBehaviour;
+			m_FrameCount[iPos] = Desc.m_iFrameCount;
+			m_SpawnTime[iPos] = flTime;
+			m_DieTime[iPos] = flTime + Desc.m_flLifetime;
+			m_FPS[iPos] = Desc.m_flFPS;
+			m_Frame[iPos] = 0;
+			m_Alpha[iPos] = Desc.m_flAlpha;
+			m_Decay[iPos] = Desc.m_flDecay;
+			m_Roll[iPos] = 0;
+			m_RollRate[iPos] = Desc.m_flRoll;
+			m_Scale[iPos] = Desc.m_flScale;
+			m_ScaleBase[iPos] = Desc.m_flScale;
+			m_ScaleInc[iPos] = Desc.m_flScaleInc;
+			m_Dead[iPos] = false;
+			m_PosOfHandle[iHandle] = (std::uint16_t)iPos;
+
+			++m_Stats.m_iSpawned;
+			m_Stats.m_iPeak = std::max(m_Stats.m_iPeak, m_iLive);
+
+			return iHandle;
+		}
+
+		// Advance frame, alpha, scale and lifetime of everything live, once per server frame.
+		void Tick(float flTime) noexcept
+		{
+			m_Expired.clear();
+
+			for (std::size_t i = 0; i < m_iLive; ++i)
+			{
+				auto const bits = m_Behaviour[i];
+				auto const flAge = flTime - m_SpawnTime[i];
+				bool bDead = false;
+
+				if (bits & FX_SPRITE_ONCE)
+				{
+					auto const flFrame = std::floor(flAge * m_FPS[i]);
+
+					bDead |= flFrame >= m_FrameCount[i];
+					m_Frame[i] = flFrame;
+				}
+
+				if (bits & FX_SKIN_ANIM)
+					m_Frame[i] = std::min(std::floor(flAge * m_FPS[i]), (float)(m_FrameCount[i] - 1));
+
+				// The fading starts on the frame after spawning.
+				if ((bits & FX_FADE_OUT) && flAge > 0)
+				{
+					auto const flPercentage = (255.f - m_Alpha[i]) / 255.f;
+
+					m_Alpha[i] -= m_Decay[i];
+					m_Roll[i] += m_RollRate[i];
+					m_Scale[i] = m_ScaleBase[i] * (1.f + flPercentage * m_ScaleInc[i]);
+
+					bDead |= m_Alpha[i] <= 0;
+				}
+
+				if (bits & FX_TIME_OUT)
+					bDead |= flTime >= m_DieTime[i];
+
+				m_Dead[i] = bDead;
+			}
+
+			// Backward, so whatever is swapped in has been looked at already.
+			for (auto i = m_iLive; i-- > 0;)
+			{
+				if (m_Dead[i])
+					Release(i);
+			}
+		}
+
+		// Forget every effect and every handle, e.g. the edicts are gone with the map.
+		void Clear() noexcept
+		{
+			m_iLive = 0;
+			m_iHandles = 0;
+			m_FreeHandles.clear();
+			m_Expired.clear();
+			std::ranges::fill(m_PosOfHandle, NPOS);
+		}
+
+	private:
+		void Release(std::size_t iPos) noexcept
+		{
+			auto const iHandle = m_Handle[iPos];
+			auto const iLast = --m_iLive;
+
+			m_PosOfHandle[iHandle] = NPOS;
+			m_FreeHandles.push_back(iHandle);
+			m_Expired.push_back(iHandle);
+
+			if (iPos == iLast)
+				return;
+
+			m_Handle[iPos] = m_Handle[iLast];
+			m_Kind[iPos] = m_Kind[iLast];
+			m_Priority[iPos] = m_Priority[iLast];
+			m_Behaviour[iPos] = m_Behaviour[iLast];
+			m_FrameCount[iPos] = m_FrameCount[iLast];
+			m_SpawnTime[iPos] = m_SpawnTime[iLast];
+			m_DieTime[iPos] = m_DieTime[iLast];
+			m_FPS[iPos] = m_FPS[iLast];
+			m_Frame[iPos] = m_Frame[iLast];
+			m_Alpha[iPos] = m_Alpha[iLast];
+			m_Decay[iPos] = m_Decay[iLast];
+			m_Roll[iPos] = m_Roll[iLast];
+			m_RollRate[iPos] = m_RollRate[iLast];
+			m_Scale[iPos] = m_Scale[iLast];
+			m_ScaleBase[iPos] = m_ScaleBase[iLast];
+			m_ScaleInc[iPos] = m_ScaleInc[iLast];
+			m_Dead[iPos] = m_Dead[iLast];
+
+			m_PosOfHandle[m_Handle[iPos]] = (std::uint16_t)iPos;
+		}
+	};
+
+	inline pool_t m_Pool{ CAPACITY };
+}
@@ -15,66 +15,8 @@ import Studio;
 import Task;
 import WinAPI;
 
+import EffectPool;
 
-enum ETaskFlags : std::uint64_t
-{
-	TASK_ANIMATION			= (1ull << 0),
-	TASK_FADE_OUT			= (1ull << 1),
-	TASK_FADE_IN			= (1ull << 2),
-	TASK_SCALING			= (1ull << 3),
-	TASK_COLOR_DRIFT		= (1ull << 4),
-	TASK_REFLECTING_FLAME	= (1ull << 5),
-	TASK_FOLLOWING			= (1ull << 6),
-	TASK_TIME_OUT			= (1ull << 7),
-	TASK_ANIMATING_SKIN		= (1ull << 8),
-	TASK_ANIMATING_BODY		= (1ull << 9),
-};
-
-
-static Task Task_SpritePlayOnce(entvars_t* const pev, short const FRAME_COUNT, double const FPS) noexcept
-{
-	short iFrame = (short)std::clamp(pev->frame, 0.f, float(FRAME_COUNT - 1));
-
-	for (; iFrame < FRAME_COUNT;)
-	{
-		co_await float(1.f / FPS);
-
-		pev->framerate = float(1.f / FPS);
-		pev->frame = ++iFrame;
-		pev->animtime = gpGlobals->time;
-	}
-
-	pev->flags |= FL_KILLME;
-}
-
-static Task Task_FadeOut(entvars_t* const pev, float const AWAIT, float const DECAY, float const ROLL, float const SCALE_INC) noexcept
-{
-	if (AWAIT > 0)
-		co_await AWAIT;
-
-	// Save the scale here to compatible with other behaviour.
-	auto const flOriginalScale = pev->scale;
-
-	for (auto flPercentage = (255.f - pev->renderamt) / 255.f;
-		pev->renderamt > 0;
-		flPercentage = (255.f - pev->renderamt) / 255.f)
-	{
-		co_await TaskScheduler::NextFrame::Rank.back();
-
-		pev->renderamt -= DECAY;
-		pev->angles.roll += ROLL;
-		pev->scale = flOriginalScale * (1.f + flPercentage * SCALE_INC);	// fade out by zooming the SPR.
-	}
-
-	pev->flags |= FL_KILLME;
-}
-
-static Task Task_Remove(entvars_t* const pev, float const TIME) noexcept
-{
-	co_await TIME;
-
-	pev->flags |= FL_KILLME;
-}
 
 static Task Task_TellMeWhere(CBasePlayer *pPlayer, Vector vecOfs) noexcept
 {
@@ -95,413 +37,574 @@ static Task Task_TellMeWhere(CBasePlayer *pPlayer, Vector vecOfs) noexcept
 }
 
 
-struct CWallPuff : Prefab_t
+// Every effect below plays on a recycled edict from EffectPool instead of a prefab of its own.
+enum struct EEffect : std::uint8_t
 {
-	static inline constexpr char CLASSNAME[] = "env_wall_puff";
-	static inline constexpr double FPS = 30.0;
-	static inline Resource::Add SPRITES[] =
-	{
-		"sprites/wall_puff1.spr",
-		"sprites/wall_puff2.spr",
-		"sprites/wall_puff3.spr",
-		"sprites/wall_puff4.spr",
-	};
-
-	CWallPuff(TraceResult const& tr) noexcept : m_tr{ tr } {}
-
-	void Spawn() noexcept override
-	{
-		auto const flLightness = UTIL_Random(1.0, 48.0);
-
-		pev->rendermode = kRenderTransAdd;
-		pev->renderamt = UTIL_Random(72.f, 96.f);	// Alpha?
-		pev->rendercolor = Vector(0xD1, 0xC5, 0x9F);	// Color. Cannot be 0x000000
-		pev->frame = 0;
+	WallPuff,
+	GunSmoke,
+	SnowSteam,
+	Spark3D,
+	SnowSplash,
+	WaterSplash,
+};
 
-		pev->solid = SOLID_NOT;
-		pev->movetype = MOVETYPE_NOCLIP;
-		pev->gravity = 0;
-		pev->scale = UTIL_Random(0.6f, 0.75f);
+// Who gets recycled first when the pool is full.
+static constexpr std::uint8_t PRIORITY_GARNISH = 0;
+static constexpr std::uint8_t PRIORITY_IMPACT = 1;
+static constexpr std::uint8_t PRIORITY_SPLASH = 2;
+static constexpr std::uint8_t PRIORITY_GUN_SMOKE = 3;
 
-		auto const WallPuffSpr = UTIL_GetRandomOne(SPRITES);
-		g_engfuncs.pfnSetModel(edict(), WallPuffSpr);
+static constexpr char EFFECT_CLASSNAME[] = "env_pooled_effect";
+static constexpr double SPRITE_FPS = 30.0;
 
-		Vector const vecDir = m_tr.vecPlaneNormal + CrossProduct(m_tr.vecPlaneNormal,
-			(m_tr.vecPlaneNormal - Vector::Up()).LengthSquared() < std::numeric_limits<float>::epsilon() ? Vector::Front() : Vector::Up()	// #INVESTIGATE why will consteval fail here?
-		);
+inline Resource::Add WALL_PUFF_SPRITES[] =
+{
+	"sprites/wall_puff1.spr",
+	"sprites/wall_puff2.spr",
+	"sprites/wall_puff3.spr",
+	"sprites/wall_puff4.spr",
+};
 
-		pev->velocity = vecDir.Normalize() * UTIL_Random(24.0, 48.0);
+inline Resource::Add SNOW_STEAM_SPRITE{ "sprites/WSIV/bettyspr5.spr" };
+inline Resource::Add SPARK_MODEL{ "models/WSIV/m_flash1.mdl" };
+inline Resource::Add SNOW_SPLASH_MODEL{ "models/WSIV/m_spark1.mdl" };
+inline Resource::Add WATER_SPLASH_MODEL{ "models/WSIV/m_spark2.mdl" };
 
-		g_engfuncs.pfnSetOrigin(edict(), m_tr.vecEndPos + m_tr.vecPlaneNormal * 24.0 * pev->scale);	// The actual SPR size will be 36 on radius. Clip the outter plain black part and it will be 24.
+// Gun smoke sprite families, by the handle UpdateGunSmokeList() gave out.
+// Owns the string so we can pass them into Resource::Precache.
+static std::vector<std::vector<std::string>> gSmokeSpriteLists{};
+static std::map<std::string, std::uint16_t, sv_iless_t> gSmokeListHandles{};
 
-		m_Scheduler.Enroll(Task_SpritePlayOnce(pev, Resource::GetSpriteTranscription(WallPuffSpr.m_pszName)->m_iNumOfFrames, FPS), TASK_ANIMATION);
-		m_Scheduler.Enroll(Task_FadeOut(pev, 0.f, 1.f, 0.07f, UTIL_Random(0.65f, 0.85f)), TASK_FADE_OUT);
-	}
+// Numbers found in place of the '*' of a file name, keyed by the lower case path with the '*' in it.
+// e.g. sprites/smoke1.spr and sprites/smoke3.spr make up "sprites/smoke*.spr" -> 0b1010.
+static std::unordered_map<std::string, std::uint32_t> gNumberedFiles{};
+static std::set<std::string, sv_iless_t> gScannedDirectories{};
 
-	static CWallPuff* Create(const TraceResult& tr) noexcept
-	{
-		auto const [pEdict, pPrefab]
-			= UTIL_CreateNamedPrefab<CWallPuff>(tr);
+struct animating_bodypart_t
+{
+	short m_iGroupIndex{};
+	short m_iSubModelsCount{};
+	float m_flInterval{};
+};
 
-		pEdict->v.origin = tr.vecEndPos;
+static int gWaterSplashSkins{};
+static std::vector<animating_bodypart_t> gWaterSplashBodyGroups{};
 
-		pPrefab->Spawn();
-		pPrefab->pev->nextthink = 0.1f;
+// Indexed by pool handle.
+static std::vector<edict_t*> gEffectEdicts{};
+static std::array<CBasePlayer*, EffectPool::CAPACITY> gSmokeOwners{};
+static std::array<Vector, EffectPool::CAPACITY> gSmokeWorldSpots{};	// Attachment #0 - on player model.
 
-		return pPrefab;
-	}
+// Indexed by entity index. NPOS for everything not in the pool.
+static std::vector<std::uint16_t> gHandleOfEdict{};
 
-	TraceResult m_tr{};
+// What an entity needs rewritten per client in AddToFullPack, by entity index.
+// Set when an effect takes its edict and cleared when the effect lets go.
+enum EPackRewrite : std::uint8_t
+{
+	PACK_NONE,
+	PACK_GUN_SMOKE,
 };
 
-edict_t* CreateWallPuff(TraceResult const& tr) noexcept
-{
-	return CWallPuff::Create(tr)->edict();
-}
+static std::vector<std::uint8_t> gPackRewrites{};
+
+// UTIL_IsFirstPersonal() of each client, refreshed on the first ask of every frame.
+static std::array<float, 33> gFirstPersonalTime{};
+static std::array<bool, 33> gFirstPersonal{};
 
-struct CGunSmoke : Prefab_t
+// Claim an edict for an effect, creating it if the pool hasn't grown this far yet.
+// Returns nullptr if every live effect is more important than this one.
+static entvars_t* SpawnEffect(EffectPool::desc_t const& Desc) noexcept
 {
-	static inline constexpr char CLASSNAME[] = "env_gun_smoke";
-	static inline constexpr double FPS = 30.0;
+	auto const iHandle = EffectPool::m_Pool.Acquire(Desc, gpGlobals->time);
 
-	// Owns the string so we can pass them into Resource::Precache.
-	static inline std::map<std::string_view, std::vector<std::string>, sv_iless_t> m_SmokeSpriteList;
+	if (iHandle == EffectPool::NPOS)
+		return nullptr;
 
-	CGunSmoke(CBasePlayer* pPlayer, Vector const& vecMuzzleOfs, std::string_view szSmokeNameRoot, int iPlayerAttIdx) noexcept
-		: m_pPlayer{ pPlayer }, m_szSmokeNameRoot{ szSmokeNameRoot },
-		m_vecViewModelMuzzle{ vecMuzzleOfs }
+	if (iHandle >= gEffectEdicts.size())
 	{
-		g_engfuncs.pfnGetAttachment(pPlayer->edict(), iPlayerAttIdx, m_vecWorldGunshotSpot, nullptr);
+		auto const pEdict = g_engfuncs.pfnCreateNamedEntity(MAKE_STRING("info_target"));
+		pEdict->v.classname = MAKE_STRING(EFFECT_CLASSNAME);
+
+		gEffectEdicts.push_back(pEdict);
+		gHandleOfEdict.resize(std::max<std::size_t>(gHandleOfEdict.size(), gpGlobals->maxEntities), EffectPool::NPOS);
+		gHandleOfEdict[ent_cast<short>(pEdict)] = iHandle;
+		gPackRewrites.resize(gHandleOfEdict.size(), PACK_NONE);
 	}
 
-	void Spawn() noexcept override
-	{
-		auto const flLightness = UTIL_Random(1.0, 48.0);
+	auto const pev = &gEffectEdicts[iHandle]->v;
+
+	// Whatever the last effect on this edict left behind.
+	pev->effects = 0;
+	pev->solid = SOLID_NOT;
+	pev->movetype = MOVETYPE_NOCLIP;
+	pev->gravity = 0;
+	pev->velocity = g_vecZero;
+	pev->angles = g_vecZero;
+	pev->owner = nullptr;
+	pev->frame = 0;
+	pev->framerate = 0;
+	pev->skin = 0;
+	pev->body = 0;
+	pev->rendermode = kRenderTransAdd;
+	pev->renderfx = kRenderFxNone;
+	pev->renderamt = Desc.m_flAlpha;
+	pev->rendercolor = Vector(0xFF, 0xFF, 0xFF);	// Color. Cannot be 0x000000
+	pev->scale = Desc.m_flScale;
+
+	gSmokeOwners[iHandle] = nullptr;
+	gPackRewrites[ent_cast<short>(pev->pContainingEntity)] = PACK_NONE;
+
+	return pev;
+}
 
-		pev->rendermode = kRenderTransAdd;
-		pev->renderamt = UTIL_Random(48.f, 72.f);	// Alpha?
-		pev->rendercolor = Vector(0xFF, 0xFF, 0xFF);	// Color. Cannot be 0x000000. Default: 0xD1, 0xC5, 0x9F
-		pev->frame = 0;
+// Drifting off the wall, away from the normal.
+static Vector WallPuffVelocity(TraceResult const& tr) noexcept
+{
+	Vector const vecDir = tr.vecPlaneNormal + CrossProduct(tr.vecPlaneNormal,
+		(tr.vecPlaneNormal - Vector::Up()).LengthSquared() < std::numeric_limits<float>::epsilon() ? Vector::Front() : Vector::Up()	// #INVESTIGATE why will consteval fail here?
+	);
 
-		pev->solid = SOLID_NOT;
-		pev->movetype = MOVETYPE_NOCLIP;
-		pev->gravity = 0;
-		pev->scale = UTIL_Random(0.2f, 0.35f);
-		pev->owner = m_pPlayer->edict();
-		pev->velocity = Vector{ 0, 0, 20 };
+	return vecDir.Normalize() * UTIL_Random(24.0, 48.0);
+}
 
-		auto const& GunSmokeSpr = UTIL_GetRandomOne(m_SmokeSpriteList.at(m_szSmokeNameRoot));
-		g_engfuncs.pfnSetModel(edict(), GunSmokeSpr.c_str());
+edict_t* CreateWallPuff(TraceResult const& tr) noexcept
+{
+	auto const& WallPuffSpr = UTIL_GetRandomOne(WALL_PUFF_SPRITES);
+
+	auto const pev = SpawnEffect({
+		.m_iKind{ (std::uint8_t)EEffect::WallPuff },
+		.m_iPriority{ PRIORITY_IMPACT },
+		.m_bitsBehaviour{ EffectPool::FX_SPRITE_ONCE | EffectPool::FX_FADE_OUT },
+		.m_iFrameCount{ (short)Resource::GetSpriteTranscription(WallPuffSpr.m_pszName)->m_iNumOfFrames },
+		.m_flFPS{ (float)SPRITE_FPS },
+		.m_flAlpha{ UTIL_Random(72.f, 96.f) },
+		.m_flDecay{ 1.f },
+		.m_flRoll{ 0.07f },
+		.m_flScale{ UTIL_Random(0.6f, 0.75f) },
+		.m_flScaleInc{ UTIL_Random(0.65f, 0.85f) },
+	});
+
+	if (!pev)
+		return nullptr;
+
+	pev->rendercolor = Vector(0xD1, 0xC5, 0x9F);
+	pev->framerate = float(1.0 / SPRITE_FPS);
+	pev->velocity = WallPuffVelocity(tr);
+
+	g_engfuncs.pfnSetModel(pev->pContainingEntity, WallPuffSpr);
+	g_engfuncs.pfnSetOrigin(pev->pContainingEntity, tr.vecEndPos + tr.vecPlaneNormal * 24.0 * pev->scale);	// The actual SPR size will be 36 on radius. Clip the outter plain black part and it will be 24.
+
+	return pev->pContainingEntity;
+}
 
-		auto const vecPredictOrg =
-			m_pPlayer->pev->origin + m_pPlayer->pev->velocity * gpGlobals->frametime * 10;	// Magic number.
+// Lower case, with the digits at [iFirst, iLast) of the file name swapped for '*'.
+[[nodiscard]] static std::string NumberedFileKey(std::string_view szDirectory, std::string_view szFile, std::size_t iFirst, std::size_t iLast) noexcept
+{
+	auto ret = std::format("{}{}*{}", szDirectory, szFile.substr(0, iFirst), szFile.substr(iLast));
 
-		auto&& [fwd, right, up]
-			= (m_pPlayer->pev->v_angle + m_pPlayer->pev->punchangle).AngleVectors();
-		g_engfuncs.pfnSetOrigin(edict(), vecPredictOrg + m_pPlayer->pev->view_ofs + up * m_vecViewModelMuzzle.z + fwd * m_vecViewModelMuzzle.x + right * m_vecViewModelMuzzle.y);
+	for (auto&& c : ret)
+		c = (char)std::tolower((unsigned char)c);
 
-		m_Scheduler.Enroll(Task_SpritePlayOnce(pev, Resource::GetSpriteTranscription(GunSmokeSpr)->m_iNumOfFrames, FPS), TASK_ANIMATION);
-		m_Scheduler.Enroll(Task_FadeOut(pev, 0.f, 1.1f, 0.07f, UTIL_Random(0.65f, 0.85f)), TASK_FADE_OUT);
-		//m_Scheduler.Enroll(Task_TellMeWhere(m_pPlayer, m_vecViewModelMuzzle));
-		//m_Scheduler.Enroll(Task_UpdateFirstPersonalPos(), TASK_FOLLOWING);
-	}
+	return ret;
+}
 
-	Task Task_UpdateFirstPersonalPos() noexcept
+// Every way of reading a number out of the name counts, so "smoke12.spr" fits both smoke*.spr and smoke1*.spr.
+static void IndexNumberedFile(std::string_view szDirectory, std::string_view szFile) noexcept
+{
+	for (std::size_t i = 0; i < szFile.size(); ++i)
 	{
-		for (; m_pPlayer && m_pPlayer->IsAlive(); co_await TaskScheduler::NextFrame::Rank[0])
+		for (auto j = i; j < szFile.size() && std::isdigit((unsigned char)szFile[j]); ++j)
 		{
-			/*
-			auto&& [fwd, right, up]
-				= m_pPlayer->pev->v_angle.AngleVectors();
+			// Spelled the way std::format("{}", i) does for i in [0, 32).
+			if (j > i && szFile[i] == '0')
+				break;
+
+			int iNumber{};
+			std::from_chars(&szFile[i], &szFile[j] + 1, iNumber);
 
-			auto const vecOrigin =
-				m_pPlayer->pev->origin + m_pPlayer->pev->view_ofs
-				+ up * m_vecViewModelMuzzle.z + fwd * m_vecViewModelMuzzle.x + right * m_vecViewModelMuzzle.y;
+			if (iNumber >= 32)
+				break;
 
-			g_engfuncs.pfnSetOrigin(this->edict(), vecOrigin);
-			*/
-			pev->velocity = m_pPlayer->pev->velocity * 1.1 + m_pPlayer->pev->basevelocity + Vector{ 0, 0, 20 };
+			gNumberedFiles[NumberedFileKey(szDirectory, szFile, i, j + 1)] |= 1u << iNumber;
 		}
 	}
+}
 
-	CBasePlayer* m_pPlayer{};
-	std::string_view m_szSmokeNameRoot{};
-	Vector m_vecWorldGunshotSpot{};	// Attachment #0 - on player model.
-	Vector m_vecViewModelMuzzle{};	// Attachment #0 - on view model.
-};
-
-void UpdateGunSmokeList(std::string_view szSmokeNameRoot) noexcept
+// One enumeration per directory for the lifetime of the server, instead of probing every candidate name.
+static void ScanDirectory(std::string_view szDirectory) noexcept
 {
-	auto& SpriteList = CGunSmoke::m_SmokeSpriteList[szSmokeNameRoot];
-	if (!SpriteList.empty())
+	if (!gScannedDirectories.emplace(szDirectory).second)
 		return;
 
-	std::string szName{ szSmokeNameRoot };
+	auto const szWildCard = std::format("{}*", szDirectory);
+	FileFindHandle_t hFind{};
+
+	for (auto psz = FileSystem::m_pObject->FindFirst(szWildCard.c_str(), &hFind, nullptr); psz; psz = FileSystem::m_pObject->FindNext(hFind))
+	{
+		if (!FileSystem::m_pObject->FindIsDirectory(hFind))
+			IndexNumberedFile(szDirectory, psz);
+	}
+
+	FileSystem::m_pObject->FindClose(hFind);
+}
+
+// A single '*' in the name stands for any of 0 to 31. Returns the handle CreateGunSmoke() takes.
+std::uint16_t UpdateGunSmokeList(std::string_view szSmokeNameRoot) noexcept
+{
+	auto it = gSmokeListHandles.find(szSmokeNameRoot);
 
-	if (szName.contains('*'))
+	if (it == gSmokeListHandles.end())
 	{
-		UTIL_ReplaceAll(&szName, "*", "{}");
+		it = gSmokeListHandles.try_emplace(std::string{ szSmokeNameRoot }, (std::uint16_t)gSmokeSpriteLists.size()).first;
+		auto& SpriteList = gSmokeSpriteLists.emplace_back();
 
-		char szFileName[256]{};
-		for (int i = 0; i < 32; ++i)
+		if (auto const iStar = szSmokeNameRoot.find('*'); iStar != std::string_view::npos)
 		{
-			auto pend = std::vformat_to(szFileName, szName, std::make_format_args(i));
-			*pend = '\0';
+			auto const iSlash = szSmokeNameRoot.find_last_of("/\\", iStar);
+			auto const szDirectory = szSmokeNameRoot.substr(0, iSlash == std::string_view::npos ? 0 : iSlash + 1);
+			auto const szFile = szSmokeNameRoot.substr(szDirectory.size());
+
+			ScanDirectory(szDirectory);
+
+			auto const iter = gNumberedFiles.find(NumberedFileKey(szDirectory, szFile, iStar - szDirectory.size(), iStar - szDirectory.size() + 1));
 
-			if (FileSystem::m_pObject->FileExists(szFileName))
-				SpriteList.emplace_back(szFileName);
+			for (auto bits = iter != gNumberedFiles.end() ? iter->second : 0u; bits; bits &= bits - 1)
+				SpriteList.push_back(std::format("{}{}{}", szSmokeNameRoot.substr(0, iStar), std::countr_zero(bits), szSmokeNameRoot.substr(iStar + 1)));
 		}
+		else
+			SpriteList.emplace_back(szSmokeNameRoot);
 	}
-	else
-		SpriteList.push_back(std::move(szName));
 
-	for (auto&& szSprite : SpriteList)
+	// Precache is wiped with every map, the lists are not.
+	for (auto&& szSprite : gSmokeSpriteLists[it->second])
 		Resource::Precache(szSprite);
-}
 
-edict_t* CreateGunSmoke(CBasePlayer* pPlayer, Vector const& vecMuzzleOfs, std::string_view szSmokeNameRoot, int iPlayerAttIdx) noexcept
-{
-	auto const [pEdict, pPrefab]
-		= UTIL_CreateNamedPrefab<CGunSmoke>(pPlayer, vecMuzzleOfs, szSmokeNameRoot, iPlayerAttIdx);
+	// A typo or a missing sprite would otherwise only show as a gun that never smokes.
+	if (gSmokeSpriteLists[it->second].empty())
+		g_engfuncs.pfnServerPrint(std::format("[WSIV] Gun smoke '{}' matches no sprite, no smoke will be made.\n", it->first).c_str());
 
-	pPrefab->Spawn();
-	pPrefab->pev->nextthink = 0.1f;
-
-	return pEdict;
+	return it->second;
 }
 
-struct CSnowSteam : Prefab_t
+edict_t* CreateGunSmoke(CBasePlayer* pPlayer, Vector const& vecMuzzleOfs, std::uint16_t iSmokeList, int iPlayerAttIdx) noexcept
 {
-	static inline constexpr char CLASSNAME[] = "env_wall_puff";
-	static inline constexpr double FPS = 30.0;
-	static inline Resource::Add STEAM_SPRITE{ "sprites/WSIV/bettyspr5.spr" };
+	auto const& SpriteList = gSmokeSpriteLists[iSmokeList];
 
-	CSnowSteam(TraceResult const& tr) noexcept : m_tr{ tr } {}
+	if (SpriteList.empty())
+		return nullptr;
 
-	void Spawn() noexcept override
-	{
-		auto const flLightness = UTIL_Random(1.0, 48.0);
+	auto const& GunSmokeSpr = UTIL_GetRandomOne(SpriteList);
 
-		pev->rendermode = kRenderTransAdd;
-		pev->renderamt = UTIL_Random(192.f, 255.f);	// Alpha?
-		pev->rendercolor = Vector(0xFF, 0xFF, 0xFF);	// Color. Cannot be 0x000000
-		pev->frame = 0;
+	auto const pev = SpawnEffect({
+		.m_iKind{ (std::uint8_t)EEffect::GunSmoke },
+		.m_iPriority{ PRIORITY_GUN_SMOKE },
+		.m_bitsBehaviour{ EffectPool::FX_SPRITE_ONCE | EffectPool::FX_FADE_OUT },
+		.m_iFrameCount{ (short)Resource::GetSpriteTranscription(GunSmokeSpr)->m_iNumOfFrames },
+		.m_flFPS{ (float)SPRITE_FPS },
+		.m_flAlpha{ UTIL_Random(48.f, 72.f) },
+		.m_flDecay{ 1.1f },
+		.m_flRoll{ 0.07f },
+		.m_flScale{ UTIL_Random(0.2f, 0.35f) },
+		.m_flScaleInc{ UTIL_Random(0.65f, 0.85f) },
+	});
 
-		pev->solid = SOLID_NOT;
-		pev->movetype = MOVETYPE_NOCLIP;
-		pev->gravity = 0;
-		pev->scale = UTIL_Random(0.6f, 0.75f);
+	if (!pev)
+		return nullptr;
 
-		g_engfuncs.pfnSetModel(edict(), STEAM_SPRITE);
+	auto const iIndex = ent_cast<short>(pev->pContainingEntity);
+	auto const iHandle = gHandleOfEdict[iIndex];
 
-		Vector const vecDir = m_tr.vecPlaneNormal + CrossProduct(m_tr.vecPlaneNormal,
-			(m_tr.vecPlaneNormal - Vector::Up()).LengthSquared() < std::numeric_limits<float>::epsilon() ? Vector::Front() : Vector::Up()
-		);
+	gPackRewrites[iIndex] = PACK_GUN_SMOKE;
+	gSmokeOwners[iHandle] = pPlayer;
+	gSmokeWorldSpots[iHandle] = UTIL_GetEntityAttachment(pPlayer->edict(), iPlayerAttIdx);
 
-		pev->velocity = vecDir.Normalize() * UTIL_Random(24.0, 48.0);
+	pev->owner = pPlayer->edict();
+	pev->framerate = float(1.0 / SPRITE_FPS);
+	pev->velocity = Vector{ 0, 0, 20 };
 
-		g_engfuncs.pfnSetOrigin(edict(), m_tr.vecEndPos + m_tr.vecPlaneNormal * 24.0 * pev->scale);
+	g_engfuncs.pfnSetModel(pev->pContainingEntity, GunSmokeSpr.c_str());
 
-		m_Scheduler.Enroll(Task_SpritePlayOnce(pev, Resource::GetSpriteTranscription(STEAM_SPRITE)->m_iNumOfFrames, FPS), TASK_ANIMATION);
-		m_Scheduler.Enroll(Task_FadeOut(pev, 0.f, 1.f, 0.07f, 0), TASK_FADE_OUT);
-	}
+	auto const vecPredictOrg =
+		pPlayer->pev->origin + pPlayer->pev->velocity * gpGlobals->frametime * 10;	// Magic number.
 
-	static CSnowSteam* Create(const TraceResult& tr) noexcept
-	{
-		auto const [pEdict, pPrefab]
-			= UTIL_CreateNamedPrefab<CSnowSteam>(tr);
-
-		pEdict->v.origin = tr.vecEndPos;
-
-		pPrefab->Spawn();
-		pPrefab->pev->nextthink = 0.1f;
-
-		return pPrefab;
-	}
+	auto&& [fwd, right, up]
+		= (pPlayer->pev->v_angle + pPlayer->pev->punchangle).AngleVectors();
+	g_engfuncs.pfnSetOrigin(pev->pContainingEntity, vecPredictOrg + pPlayer->pev->view_ofs + up * vecMuzzleOfs.z + fwd * vecMuzzleOfs.x + right * vecMuzzleOfs.y);
 
-	TraceResult m_tr{};
-};
+	return pev->pContainingEntity;
+}
 
-edict_t* CreateSnowSteam(TraceResult const& tr) noexcept
+edict_t* CreateSnowSteam(TraceResult const& tr)
 {
-	return CSnowSteam::Create(tr)->edict();
+	auto const pev = SpawnEffect({
+		.m_iKind{ (std::uint8_t)EEffect::SnowSteam },
+		.m_iPriority{ PRIORITY_GARNISH },
+		.m_bitsBehaviour{ EffectPool::FX_SPRITE_ONCE | EffectPool::FX_FADE_OUT },
+		.m_iFrameCount{ (short)Resource::GetSpriteTranscription(SNOW_STEAM_SPRITE)->m_iNumOfFrames },
+		.m_flFPS{ (float)SPRITE_FPS },
+		.m_flAlpha{ UTIL_Random(192.f, 255.f) },
+		.m_flDecay{ 1.f },
+		.m_flRoll{ 0.07f },
+		.m_flScale{ UTIL_Random(0.6f, 0.75f) },
+		.m_flScaleInc{ 0 },
+	});
+
+	if (!pev)
+		return nullptr;
+
+	pev->framerate = float(1.0 / SPRITE_FPS);
+	pev->velocity = WallPuffVelocity(tr);
+
+	g_engfuncs.pfnSetModel(pev->pContainingEntity, SNOW_STEAM_SPRITE);
+	g_engfuncs.pfnSetOrigin(pev->pContainingEntity, tr.vecEndPos + tr.vecPlaneNormal * 24.0 * pev->scale);
+
+	return pev->pContainingEntity;
 }
 
-struct CSpark3D : Prefab_t
+// Studio model flashes stuck on the wall for a blink.
+static entvars_t* SpawnSpark(TraceResult const& tr, EEffect iKind, float flHoldTime, float flAlpha, char const* pszModel) noexcept
 {
-	static inline constexpr char CLASSNAME[] = "env_spark_3d";
-	static inline Resource::Add SPARK_MODEL{ "models/WSIV/m_flash1.mdl" };
-	static inline constexpr auto HOLD_TIME = 0.07f;
-
-	void Spawn() noexcept override
-	{
-		pev->solid = SOLID_NOT;
-		pev->movetype = MOVETYPE_NONE;
-		pev->gravity = 0;
-		pev->rendermode = kRenderTransAdd;
-		pev->renderfx = kRenderFxNone;
-		pev->renderamt = UTIL_Random(192.f, 255.f);
+	auto const pev = SpawnEffect({
+		.m_iKind{ (std::uint8_t)iKind },
+		.m_iPriority{ iKind == EEffect::Spark3D ? PRIORITY_IMPACT : PRIORITY_GARNISH },
+		.m_bitsBehaviour{ EffectPool::FX_TIME_OUT },
+		.m_flAlpha{ flAlpha },
+		.m_flScale{ 1.f },
+		.m_flLifetime{ flHoldTime },
+	});
+
+	if (!pev)
+		return nullptr;
+
+	pev->movetype = MOVETYPE_NONE;
+	pev->angles = tr.vecPlaneNormal.VectorAngles();
+
+	g_engfuncs.pfnSetModel(pev->pContainingEntity, pszModel);
+	g_engfuncs.pfnSetSize(pev->pContainingEntity, Vector::Zero(), Vector::Zero());
+	g_engfuncs.pfnSetOrigin(pev->pContainingEntity, tr.vecEndPos);
+
+	return pev;
+}
 
-		auto const iValue = UTIL_Random(0, 4);
-		switch (iValue)
-		{
-		case 0:
-		case 1:
-		case 2:
-		case 3:
-			pev->body = 0;
-			pev->skin = iValue;
-			break;
-
-		case 4:
-			pev->body = 1;
-			break;
-
-		default:
-			std::unreachable();
-		}
+edict_t* CreateSpark3D(TraceResult const& tr) noexcept
+{
+	auto const pev = SpawnSpark(tr, EEffect::Spark3D, 0.07f, UTIL_Random(192.f, 255.f), SPARK_MODEL);
 
-		g_engfuncs.pfnSetModel(edict(), SPARK_MODEL);
-		g_engfuncs.pfnSetSize(edict(), Vector::Zero(), Vector::Zero());
-		g_engfuncs.pfnSetOrigin(edict(), pev->origin);
+	if (!pev)
+		return nullptr;
 
-		m_Scheduler.Enroll(Task_Remove(pev, HOLD_TIME), TASK_TIME_OUT);
+	auto const iValue = UTIL_Random(0, 4);
+	switch (iValue)
+	{
+	case 0:
+	case 1:
+	case 2:
+	case 3:
+		pev->body = 0;
+		pev->skin = iValue;
+		break;
+
+	case 4:
+		pev->body = 1;
+		break;
+
+	default:
+		std::unreachable();
 	}
-};
 
-edict_t* CreateSpark3D(TraceResult const& tr) noexcept
-{
-	return Prefab_t::Create<CSpark3D>(tr.vecEndPos, tr.vecPlaneNormal.VectorAngles())->edict();
+	return pev->pContainingEntity;
 }
 
-static Resource::Add g_SnowSplashModel{ "models/WSIV/m_spark1.mdl" };
-
 edict_t* CreateSnowSplash(TraceResult const& tr) noexcept
 {
-	auto const pSplashEnt = Prefab_t::Create<CSpark3D>(tr.vecEndPos, tr.vecPlaneNormal.VectorAngles());
+	auto const pev = SpawnSpark(tr, EEffect::SnowSplash, 0.05f, UTIL_Random(32.f, 64.f), SNOW_SPLASH_MODEL);
 
-	g_engfuncs.pfnSetModel(pSplashEnt->edict(), g_SnowSplashModel);
-	pSplashEnt->pev->body = UTIL_Random(0, 3);
-	pSplashEnt->pev->skin = UTIL_Random(0, 3);
-	pSplashEnt->pev->renderamt = UTIL_Random(32.f, 64.f);
+	if (!pev)
+		return nullptr;
 
-	pSplashEnt->m_Scheduler.Enroll(Task_Remove(pSplashEnt->pev, 0.05f), TASK_TIME_OUT, true);
+	pev->body = UTIL_Random(0, 3);
+	pev->skin = UTIL_Random(0, 3);
 
-	return pSplashEnt->edict();
+	return pev->pContainingEntity;
 }
 
-struct CWaterSplash : Prefab_t
+// Skins and every "animated_<fps>" body group of the splash model play at once.
+static void RetrieveWaterSplashAnim() noexcept
 {
-	static inline constexpr char CLASSNAME[] = "env_water_splash_3d";
-	static inline Resource::Add SPLASH_MODEL{ "models/WSIV/m_spark2.mdl" };
+	static bool bPrecached = false;
+	if (bPrecached) [[likely]]
+		return;
+
+	auto const pStudioInfo = Resource::GetStudioTranscription(WATER_SPLASH_MODEL);
+	gWaterSplashSkins = std::ssize(pStudioInfo->m_Skins);
 
-	struct animating_bodypart_t
+	for (int i = 0; i < std::ssize(pStudioInfo->m_Parts); ++i)
 	{
-		short m_iGroupIndex{};
-		short m_iSubModelsCount{};
-		float m_flInterval{};
-	};
+		std::string_view const szName{ pStudioInfo->m_Parts[i].m_szName};
+		if (!szName.starts_with("animated_"))
+			continue;
 
-	static inline int m_iSkinAnimFrames{};
-	static inline std::vector<animating_bodypart_t> m_rgAnimatingBodyGroups{};
+		auto const pos = szName.find_first_of('_');
+		if (pos == szName.npos)
+			continue;
 
-	void Spawn() noexcept override
-	{
-		pev->solid = SOLID_NOT;
-		pev->movetype = MOVETYPE_NONE;
-		pev->gravity = 0;
-		pev->rendermode = kRenderTransAdd;
-		pev->renderfx = kRenderFxNone;
-		pev->renderamt = UTIL_Random(192.f, 255.f);
+		auto const szNum = szName.substr(pos + 1);
+
+		gWaterSplashBodyGroups.emplace_back(
+			(short)i,
+			(short)pStudioInfo->m_Parts[i].m_SubModels.size(),
+			1.f / UTIL_StrToNum<float>(szNum)
+		);
+	}
+
+	bPrecached = true;
+}
 
-		g_engfuncs.pfnSetModel(edict(), SPLASH_MODEL);
-		g_engfuncs.pfnSetOrigin(edict(), pev->origin);
-		g_engfuncs.pfnSetSize(edict(), Vector::Zero(), Vector::Zero());
+edict_t* CreateWaterSplash3D(Vector const& vecOrigin) noexcept
+{
+	static constexpr float SKIN_FPS = 60.f;
 
-		Precache();
+	RetrieveWaterSplashAnim();
 
-		m_Scheduler.Enroll(Task_SkinAnimation(60.f), TASK_TIME_OUT | TASK_ANIMATION | TASK_ANIMATING_SKIN);
+	// Lives until both the skins and the slowest body group are done.
+	auto flLifetime = (float)gWaterSplashSkins / SKIN_FPS;
 
-		for (auto&& info : m_rgAnimatingBodyGroups)
-			m_Scheduler.Enroll(Task_BodyPartAnimation(info), TASK_ANIMATION | TASK_ANIMATING_BODY);
-	}
+	for (auto&& info : gWaterSplashBodyGroups)
+		flLifetime = std::max(flLifetime, info.m_iSubModelsCount * info.m_flInterval);
 
-	void Precache() noexcept override
-	{
-		static bool bPrecached = false;
-		if (bPrecached) [[likely]]
-			return;
+	auto const pev = SpawnEffect({
+		.m_iKind{ (std::uint8_t)EEffect::WaterSplash },
+		.m_iPriority{ PRIORITY_SPLASH },
+		.m_bitsBehaviour{ EffectPool::FX_SKIN_ANIM | EffectPool::FX_TIME_OUT },
+		.m_iFrameCount{ (short)std::max(gWaterSplashSkins, 1) },
+		.m_flFPS{ SKIN_FPS },
+		.m_flAlpha{ UTIL_Random(192.f, 255.f) },
+		.m_flScale{ 1.f },
+		.m_flLifetime{ flLifetime },
+	});
 
-		auto const pStudioInfo = Resource::GetStudioTranscription(SPLASH_MODEL);
-		m_iSkinAnimFrames = std::ssize(pStudioInfo->m_Skins);
+	if (!pev)
+		return nullptr;
 
-		for (int i = 0; i < std::ssize(pStudioInfo->m_Parts); ++i)
-		{
-			std::string_view const szName{ pStudioInfo->m_Parts[i].m_szName};
-			if (!szName.starts_with("animated_"))
-				continue;
+	pev->movetype = MOVETYPE_NONE;
+	pev->angles = Angles::Upwards();
 
-			auto const pos = szName.find_first_of('_');
-			if (pos == szName.npos)
-				continue;
+	g_engfuncs.pfnSetModel(pev->pContainingEntity, WATER_SPLASH_MODEL);
+	g_engfuncs.pfnSetSize(pev->pContainingEntity, Vector::Zero(), Vector::Zero());
+	g_engfuncs.pfnSetOrigin(pev->pContainingEntity, vecOrigin);
 
-			auto const szNum = szName.substr(pos + 1);
+	return pev->pContainingEntity;
+}
 
-			m_rgAnimatingBodyGroups.emplace_back(
-				(short)i,
-				(short)pStudioInfo->m_Parts[i].m_SubModels.size(),
-				1.f / UTIL_StrToNum<float>(szNum)
-			);
-		}
-	}
+// Once per frame: advance every pooled effect and copy the result onto its edict.
+void ThinkEffects() noexcept
+{
+	auto& Pool = EffectPool::m_Pool;
+
+	Pool.Tick(gpGlobals->time);
 
-	Task Task_SkinAnimation(float FPS) noexcept
+	for (std::size_t i = 0; i < Pool.m_iLive; ++i)
 	{
-		for (int i = 0; i < m_iSkinAnimFrames; co_await (1.f / FPS), ++i)
+		auto const pev = &gEffectEdicts[Pool.m_Handle[i]]->v;
+		auto const bits = Pool.m_Behaviour[i];
+
+		if ((bits & EffectPool::FX_SPRITE_ONCE) && pev->frame != Pool.m_Frame[i])
 		{
-			pev->skin = i;
+			pev->frame = Pool.m_Frame[i];
+			pev->animtime = gpGlobals->time;
 		}
 
-		while (m_Scheduler.Exist(TASK_ANIMATING_BODY))
-			co_await 0.1f;
+		if (bits & EffectPool::FX_FADE_OUT)
+		{
+			pev->renderamt = Pool.m_Alpha[i];
+			pev->angles.roll = Pool.m_Roll[i];
+			pev->scale = Pool.m_Scale[i];
+		}
 
-		pev->flags |= FL_KILLME;
-	}
+		if (bits & EffectPool::FX_SKIN_ANIM)
+			pev->skin = (int)Pool.m_Frame[i];
 
-	Task Task_BodyPartAnimation(animating_bodypart_t info) noexcept
-	{
-		for (int i = 0; i < info.m_iSubModelsCount; co_await info.m_flInterval, ++i)
+		if (Pool.m_Kind[i] == (std::uint8_t)EEffect::WaterSplash)
 		{
-			SetBodygroup(pev, info.m_iGroupIndex, i);
+			auto const flAge = gpGlobals->time - Pool.m_SpawnTime[i];
+
+			for (auto&& info : gWaterSplashBodyGroups)
+				SetBodygroup(pev, info.m_iGroupIndex, std::min((int)(flAge / info.m_flInterval), info.m_iSubModelsCount - 1));
 		}
 	}
-};
 
-edict_t* CreateWaterSplash3D(Vector const& vecOrigin) noexcept
-{
-	return Prefab_t::Create<CWaterSplash>(vecOrigin, Angles::Upwards())->edict();
+	// Parked until someone needs them again.
+	for (auto&& iHandle : Pool.m_Expired)
+	{
+		auto const pev = &gEffectEdicts[iHandle]->v;
+
+		pev->effects |= EF_NODRAW;
+		pev->movetype = MOVETYPE_NONE;
+		pev->velocity = g_vecZero;
+		pev->owner = nullptr;
+		gSmokeOwners[iHandle] = nullptr;
+		gPackRewrites[ent_cast<short>(pev->pContainingEntity)] = PACK_NONE;
+	}
 }
 
-// Forwards
+// The edicts are freed by the engine on map change.
+void ClearEffects() noexcept
+{
+	EffectPool::m_Pool.Clear();
+	gEffectEdicts.clear();
+	gHandleOfEdict.clear();
+	gPackRewrites.clear();
+	gSmokeOwners.fill(nullptr);
+	gFirstPersonalTime.fill(0);
+}
 
-void Effect_AddToFullPack_Post(entity_state_t* pState, edict_t* pEdict, edict_t* pClientSendTo, bool bIsPlayer) noexcept
+static bool IsFirstPersonal(edict_t* pPlayer) noexcept
 {
-	if (bIsPlayer || !UTIL_IsLocalRtti(pEdict->pvPrivateData)) [[likely]]
-		return;
+	auto const iPlayer = ent_cast<short>(pPlayer);
 
-	auto const pEntity = ent_cast<CBaseEntity*>(pEdict);
-	auto const pGunSmoke = dynamic_cast<CGunSmoke*>(pEntity);
+	if (iPlayer < 1 || iPlayer >= std::ssize(gFirstPersonal)) [[unlikely]]
+		return UTIL_IsFirstPersonal(pPlayer);
 
-	if (pGunSmoke == nullptr)
-		return;
+	if (gFirstPersonalTime[iPlayer] != gpGlobals->time)
+	{
+		gFirstPersonalTime[iPlayer] = gpGlobals->time;
+		gFirstPersonal[iPlayer] = UTIL_IsFirstPersonal(pPlayer);
+	}
+
+	return gFirstPersonal[iPlayer];
+}
 
-	auto const pOwnerEdict = pGunSmoke->m_pPlayer->edict();
-	if (pClientSendTo != pOwnerEdict
-		|| (pClientSendTo == pOwnerEdict && !UTIL_IsFirstPersonal(pOwnerEdict)))
+// Everyone but the owner in first person sees the smoke on the world model muzzle.
+static void PackGunSmoke(entity_state_t* pState, int iEntIndex, edict_t* pClientSendTo) noexcept
+{
+	auto const iHandle = gHandleOfEdict[iEntIndex];
+	auto const pOwnerEdict = gSmokeOwners[iHandle]->edict();
+
+	if (pClientSendTo != pOwnerEdict || !IsFirstPersonal(pOwnerEdict))
 	{
 		pState->movetype = MOVETYPE_NONE;
 		pState->velocity = g_vecZero;
-		pState->origin = pGunSmoke->m_vecWorldGunshotSpot;
+		pState->origin = gSmokeWorldSpots[iHandle];
 		pState->scale = 0.65f;
 	}
 }
+
+using pfn_pack_rewrite_t = void (*)(entity_state_t* pState, int iEntIndex, edict_t* pClientSendTo) noexcept;
+
+static constexpr pfn_pack_rewrite_t PACK_REWRITES[] =
+{
+	/* PACK_NONE */			nullptr,
+	/* PACK_GUN_SMOKE */	&PackGunSmoke,
+};
+
+// Forwards
+
+void Effect_AddToFullPack_Post(entity_state_t* pState, int iEntIndex, edict_t* pClientSendTo, bool bIsPlayer) noexcept
+{
+	if (bIsPlayer || (std::size_t)iEntIndex >= gPackRewrites.size()) [[likely]]
+		return;
+
+	if (auto const iRewrite = gPackRewrites[iEntIndex]; iRewrite != PACK_NONE)
+		PACK_REWRITES[iRewrite](pState, iEntIndex, pClientSendTo);
+}
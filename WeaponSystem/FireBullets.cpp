@@ -19,6 +19,8 @@ import Uranus;
 import ZBot;
 
 import Ammo;
+import ImpactBudget;
+import TextureCache;
 
 
 #pragma region EFFECT_RES
@@ -151,6 +153,249 @@ inline Resource::Add SFX_RICO_METAL[] =
 
 #pragma endregion EFFECT_RES
 
+#pragma region MATERIAL
+
+// Gibs thrown off the wall by an impact.
+struct debris_t final
+{
+	Resource::Add const* m_pGibs{};
+	float m_flSize{};	// Invalid Arg?
+	uint8_t m_iFlags{};
+	bool m_bWallPuff{};
+};
+
+static debris_t const DEBRIS_WOOD{ &GIBS_WOOD, 1.f, BREAK_WOOD, true };
+static debris_t const DEBRIS_CONCRETE{ &GIBS_CONCRETE, 0.1f, BREAK_NONE, true };
+static debris_t const DEBRIS_GLASS{ &GIBS_GLASS, 1.f, BREAK_GLASS | BREAK_TRANS, true };
+static debris_t const DEBRIS_FLORA{ &GIBS_FLORA, 1.f, BREAK_NONE, false };
+
+enum struct EImpactFx : uint8_t
+{
+	WallPuff,
+	None,
+	Sparks,
+	Debris,
+	Snow,
+};
+
+enum struct ERicochet : uint8_t
+{
+	Generic,
+	None,
+	Metal,
+};
+
+// Everything a bullet needs to know about the surface it hits, indexed by CHAR_TEX_*.
+struct material_t final
+{
+	// Penetration
+	float m_flPenetrationPower{ 1.f };		// Scales the remaining penetration power.
+	std::optional<float> m_flDamageModifier{};	// Damage kept after passing through. Unset leaves the previous one in place.
+
+	// Impact
+	EImpactFx m_ImpactFx{ EImpactFx::WallPuff };
+	debris_t const* m_pDebris{};
+
+	// Sound
+	std::span<Resource::Add const> m_HitSounds{};
+	float m_flHitVolume{ VOL_NORM };
+	float m_flHitAttn{ ATTN_NORM };
+	ERicochet m_Ricochet{ ERicochet::Generic };
+};
+
+using material_table_t = std::array<material_t, 256>;
+
+static material_table_t DefaultMaterials() noexcept
+{
+	material_table_t ret{};
+
+	auto const fnSet = [&](char cTextureType, material_t const& Material) noexcept { ret[(uint8_t)cTextureType] = Material; };
+
+	// Absolutely no effect on these two.
+	fnSet(CHAR_TEX_FLESH, { .m_ImpactFx{ EImpactFx::None }, .m_Ricochet{ ERicochet::None } });
+	fnSet(CHAR_TEX_SLOSH, { .m_ImpactFx{ EImpactFx::None }, .m_HitSounds{ SFX_HIT_SLOSH }, .m_flHitVolume{ 0.9f }, .m_Ricochet{ ERicochet::None } });
+
+	fnSet(CHAR_TEX_METAL, { .m_flPenetrationPower{ 0.15f }, .m_flDamageModifier{ 0.2f }, .m_ImpactFx{ EImpactFx::Sparks }, .m_HitSounds{ SFX_HIT_METAL }, .m_flHitVolume{ 0.9f }, .m_Ricochet{ ERicochet::Metal } });
+	fnSet(CHAR_TEX_VENT, { .m_flPenetrationPower{ 0.5f }, .m_flDamageModifier{ 0.45f }, .m_ImpactFx{ EImpactFx::Sparks }, .m_HitSounds{ SFX_HIT_VENT }, .m_flHitVolume{ 0.5f }, .m_Ricochet{ ERicochet::Metal } });
+	fnSet(CHAR_TEX_GRATE, { .m_flPenetrationPower{ 0.5f }, .m_flDamageModifier{ 0.4f }, .m_ImpactFx{ EImpactFx::Sparks }, .m_HitSounds{ SFX_HIT_GRATE }, .m_flHitVolume{ 0.9f }, .m_Ricochet{ ERicochet::Metal } });
+	fnSet(CHAR_TEX_COMPUTER, { .m_flPenetrationPower{ 0.4f }, .m_flDamageModifier{ 0.45f }, .m_ImpactFx{ EImpactFx::Sparks }, .m_HitSounds{ SFX_HIT_GLASS }, .m_flHitVolume{ 0.8f }, .m_Ricochet{ ERicochet::Metal } });
+
+	fnSet(CHAR_TEX_WOOD, { .m_flDamageModifier{ 0.6f }, .m_ImpactFx{ EImpactFx::Debris }, .m_pDebris{ &DEBRIS_WOOD }, .m_HitSounds{ SFX_HIT_WOOD }, .m_flHitVolume{ 0.9f } });
+	fnSet(CHAR_TEX_CONCRETE, { .m_flPenetrationPower{ 0.25f }, .m_ImpactFx{ EImpactFx::Debris }, .m_pDebris{ &DEBRIS_CONCRETE } });
+	fnSet(CHAR_TEX_DIRT, { .m_ImpactFx{ EImpactFx::Debris }, .m_pDebris{ &DEBRIS_CONCRETE }, .m_HitSounds{ SFX_HIT_DIRT }, .m_flHitVolume{ 0.9f } });
+	fnSet(CHAR_TEX_TILE, { .m_flPenetrationPower{ 0.65f }, .m_flDamageModifier{ 0.3f }, .m_ImpactFx{ EImpactFx::Debris }, .m_pDebris{ &DEBRIS_CONCRETE }, .m_HitSounds{ SFX_HIT_TILE }, .m_flHitVolume{ 0.8f } });
+	fnSet(CHAR_TEX_GRAVEL, { .m_ImpactFx{ EImpactFx::Debris }, .m_pDebris{ &DEBRIS_CONCRETE }, .m_HitSounds{ SFX_HIT_GRAVEL }, .m_flHitVolume{ 0.9f } });
+	fnSet(CHAR_TEX_GLASS, { .m_ImpactFx{ EImpactFx::Debris }, .m_pDebris{ &DEBRIS_GLASS }, .m_HitSounds{ SFX_HIT_GLASS }, .m_flHitVolume{ 0.8f } });
+
+	// Extentions by CZDS
+	fnSet(CHAR_TEX_SNOW, { .m_ImpactFx{ EImpactFx::Snow }, .m_HitSounds{ SFX_HIT_SNOW }, .m_flHitVolume{ 0.7f }, .m_Ricochet{ ERicochet::None } });
+	fnSet(CHAR_TEX_CARPET, { .m_HitSounds{ SFX_HIT_CARPET }, .m_flHitVolume{ 1.f }, .m_flHitAttn{ ATTN_STATIC } });
+	fnSet(CHAR_TEX_GRASS_CS, { .m_ImpactFx{ EImpactFx::Debris }, .m_pDebris{ &DEBRIS_FLORA }, .m_HitSounds{ SFX_HIT_GRASS }, .m_flHitVolume{ 1.f }, .m_flHitAttn{ ATTN_STATIC } });
+	fnSet(CHAR_TEX_GRASS_CZ, { .m_ImpactFx{ EImpactFx::Debris }, .m_pDebris{ &DEBRIS_FLORA }, .m_HitSounds{ SFX_HIT_GRASS }, .m_flHitVolume{ 1.f }, .m_flHitAttn{ ATTN_STATIC } });
+
+	return ret;
+}
+
+static material_table_t gMaterials = DefaultMaterials();
+
+// Per map overrides. One material per line, keyed by its texture type character, e.g.
+// M penetration=0.15 damage=0.2 impact=sparks sound=metal volume=0.9 attn=0.8 ricochet=metal
+static constexpr char MATERIAL_CONFIG[] = "addons/metamod/WSIV_Materials.txt";
+
+static std::pair<string_view, std::span<Resource::Add const>> const MATERIAL_SOUNDS[] =
+{
+	{ "none", {} },
+	{ "metal", SFX_HIT_METAL },
+	{ "dirt", SFX_HIT_DIRT },
+	{ "vent", SFX_HIT_VENT },
+	{ "grate", SFX_HIT_GRATE },
+	{ "tile", SFX_HIT_TILE },
+	{ "slosh", SFX_HIT_SLOSH },
+	{ "snow", SFX_HIT_SNOW },
+	{ "wood", SFX_HIT_WOOD },
+	{ "glass", SFX_HIT_GLASS },
+	{ "carpet", SFX_HIT_CARPET },
+	{ "grass", SFX_HIT_GRASS },
+	{ "gravel", SFX_HIT_GRAVEL },
+};
+
+static constexpr std::tuple<string_view, EImpactFx, debris_t const*> MATERIAL_IMPACTS[] =
+{
+	{ "puff", EImpactFx::WallPuff, nullptr },
+	{ "none", EImpactFx::None, nullptr },
+	{ "sparks", EImpactFx::Sparks, nullptr },
+	{ "wood", EImpactFx::Debris, &DEBRIS_WOOD },
+	{ "concrete", EImpactFx::Debris, &DEBRIS_CONCRETE },
+	{ "glass", EImpactFx::Debris, &DEBRIS_GLASS },
+	{ "flora", EImpactFx::Debris, &DEBRIS_FLORA },
+	{ "snow", EImpactFx::Snow, nullptr },
+};
+
+static constexpr std::pair<string_view, ERicochet> MATERIAL_RICOCHETS[] =
+{
+	{ "generic", ERicochet::Generic },
+	{ "none", ERicochet::None },
+	{ "metal", ERicochet::Metal },
+};
+
+// Start over from the built-in table, then apply the config of this server, if any.
+void LoadMaterials() noexcept
+{
+	gMaterials = DefaultMaterials();
+
+	auto const f = FileSystem::FOpen(MATERIAL_CONFIG, "rt");
+	if (!f)
+		return;
+
+	auto const fnNextWord = [](string_view& sz) noexcept -> string_view
+	{
+		static constexpr string_view SPACES = " \t\r\n";
+
+		sz.remove_prefix(std::min(sz.find_first_not_of(SPACES), sz.size()));
+		auto const ret = sz.substr(0, sz.find_first_of(SPACES));
+		sz.remove_prefix(ret.size());
+
+		return ret;
+	};
+
+	auto const fnError = [](int iLine, string_view szWhat) noexcept
+	{
+		g_engfuncs.pfnServerPrint(std::format("[WSIV] {}({}): {}\n", MATERIAL_CONFIG, iLine, szWhat).c_str());
+	};
+
+	char szLine[256]{};
+
+	for (int iLine = 1; std::fgets(szLine, sizeof(szLine), f); ++iLine)
+	{
+		string_view sz{ szLine };
+		sz = sz.substr(0, sz.find("//"));
+
+		auto const szType = fnNextWord(sz);
+		if (szType.empty())
+			continue;
+
+		if (szType.size() != 1)
+		{
+			fnError(iLine, std::format("'{}' is not a texture type character", szType));
+			continue;
+		}
+
+		auto& Material = gMaterials[(uint8_t)szType.front()];
+
+		for (auto szPair = fnNextWord(sz); !szPair.empty(); szPair = fnNextWord(sz))
+		{
+			auto const iEq = szPair.find('=');
+			auto const szKey = szPair.substr(0, iEq);
+			auto const szValue = iEq == string_view::npos ? string_view{} : szPair.substr(iEq + 1);
+
+			// Only a value which parses as a whole replaces the current one.
+			auto const fnNumber = [&]() noexcept -> std::optional<float>
+			{
+				float flValue{};
+				auto const [ptr, ec] = std::from_chars(szValue.data(), szValue.data() + szValue.size(), flValue);
+
+				if (ec != std::errc{} || ptr != szValue.data() + szValue.size())
+				{
+					fnError(iLine, std::format("'{}' expects a number, but '{}' was given", szKey, szValue));
+					return std::nullopt;
+				}
+
+				return flValue;
+			};
+
+			if (szKey == "penetration")
+			{
+				if (auto const fl = fnNumber(); fl)
+					Material.m_flPenetrationPower = *fl;
+			}
+			else if (szKey == "damage")
+			{
+				if (szValue == "keep")
+					Material.m_flDamageModifier.reset();
+				else if (auto const fl = fnNumber(); fl)
+					Material.m_flDamageModifier = *fl;
+			}
+			else if (szKey == "volume")
+			{
+				if (auto const fl = fnNumber(); fl)
+					Material.m_flHitVolume = *fl;
+			}
+			else if (szKey == "attn")
+			{
+				if (auto const fl = fnNumber(); fl)
+					Material.m_flHitAttn = *fl;
+			}
+			else if (szKey == "sound")
+			{
+				if (auto const it = std::ranges::find(MATERIAL_SOUNDS, szValue, &std::pair<string_view, std::span<Resource::Add const>>::first); it != std::ranges::end(MATERIAL_SOUNDS))
+					Material.m_HitSounds = it->second;
+				else
+					fnError(iLine, std::format("Unknown sound bank '{}'", szValue));
+			}
+			else if (szKey == "impact")
+			{
+				if (auto const it = std::ranges::find(MATERIAL_IMPACTS, szValue, [](auto&& t) noexcept { return std::get<0>(t); }); it != std::ranges::end(MATERIAL_IMPACTS))
+					std::tie(std::ignore, Material.m_ImpactFx, Material.m_pDebris) = *it;
+				else
+					fnError(iLine, std::format("Unknown impact effect '{}'", szValue));
+			}
+			else if (szKey == "ricochet")
+			{
+				if (auto const it = std::ranges::find(MATERIAL_RICOCHETS, szValue, &std::pair<string_view, ERicochet>::first); it != std::ranges::end(MATERIAL_RICOCHETS))
+					Material.m_Ricochet = it->second;
+				else
+					fnError(iLine, std::format("Unknown ricochet '{}'", szValue));
+			}
+			else
+				fnError(iLine, std::format("Unknown key '{}'", szKey));
+		}
+	}
+
+	std::fclose(f);
+}
+
+#pragma endregion MATERIAL
+
 // Effect.cpp
 extern edict_t* CreateWallPuff(TraceResult const& tr) noexcept;
 extern edict_t* CreateSnowSteam(TraceResult const& tr);
@@ -159,102 +404,144 @@ extern edict_t* CreateSnowSplash(TraceResult const& tr) noexcept;
 extern edict_t* CreateWaterSplash3D(Vector const& vecOrigin) noexcept;
 //
 
-static Task VFX_WaterSplash(Vector vecSrc, Vector vecEnd) noexcept
+#pragma region WATER
+
+// Water surface height per column of the map, learnt from earlier shots. Cleared on map change.
+static constexpr float WATER_COLUMN_SIZE = 64.f;
+static std::unordered_map<std::uint64_t, float> gWaterSurfaces{};
+
+static std::uint64_t WaterColumnKey(Vector const& vec) noexcept
 {
-	// Assume that player doesn't shooting from water,
-	// not shooting through water
-	// and not that close to the water.
+	auto const x = (std::int32_t)std::floor(vec.x / WATER_COLUMN_SIZE);
+	auto const y = (std::int32_t)std::floor(vec.y / WATER_COLUMN_SIZE);
 
-	assert(g_engfuncs.pfnPointContents(vecEnd) == CONTENTS_WATER);
+	return (std::uint64_t)(std::uint32_t)x << 32 | (std::uint32_t)y;
+}
 
-	auto vecDir = vecEnd - vecSrc;
-	auto iCounter = 0z;
+// A surface is only worth remembering if it is a flat water plane at this height.
+static bool IsWaterPlane(Vector const& vecPoint, float flHeight) noexcept
+{
+	return g_engfuncs.pfnPointContents(Vector{ vecPoint.x, vecPoint.y, flHeight - 2.f }) == CONTENTS_WATER
+		&& g_engfuncs.pfnPointContents(Vector{ vecPoint.x, vecPoint.y, flHeight + 2.f }) != CONTENTS_WATER;
+}
 
-	for (;
-		g_engfuncs.pfnPointContents(vecSrc) != g_engfuncs.pfnPointContents(vecEnd);
-		co_await TaskScheduler::NextFrame::Rank[0])
+// Where does vecSrc -> vecEnd enter the water? vecEnd must be in water and vecSrc must not.
+// Resolves in the calling frame: a remembered plane costs two probes, otherwise a bisection with one probe per step.
+static Vector FindWaterSurface(Vector vecSrc, Vector vecEnd) noexcept
+{
+	// There is no trace against water in the engine API, pfnTraceLine goes right through it.
+	static constexpr auto MAX_STEPS = 16;
+
+	auto const iColumn = WaterColumnKey(vecEnd);
+
+	if (auto const it = gWaterSurfaces.find(iColumn); it != gWaterSurfaces.end())
 	{
-		vecSrc += vecDir * 0.5;
-		vecDir *= 0.5;
+		auto const flHeight = it->second;
 
-		if (g_engfuncs.pfnPointContents(vecSrc) == CONTENTS_WATER)
-			break;
+		if (vecSrc.z > flHeight && vecEnd.z < flHeight)
+		{
+			auto const vecSurface = vecSrc + (vecEnd - vecSrc) * ((vecSrc.z - flHeight) / (vecSrc.z - vecEnd.z));
 
-		++iCounter;
+			if (IsWaterPlane(vecSurface, flHeight))
+				return vecSurface;
+		}
 	}
 
-	auto iCounter2 = 0z;
-
-	for (vecEnd = vecSrc - vecDir;	// In the first iteration we are certain that we should go back, and vecSrc is under water.
-		vecDir.LengthSquared() > 4.0 * 4.0;
-		co_await TaskScheduler::NextFrame::Rank[0], ++iCounter2)
+	// Both ends are known, so only the midpoint gets probed.
+	for (auto i = 0; i < MAX_STEPS && (vecEnd - vecSrc).LengthSquared() > 1.0 * 1.0; ++i)
 	{
-		vecDir = (vecEnd - vecSrc) * 0.5;
-		auto const vecMid = vecSrc + vecDir;
+		auto const vecMid = (vecSrc + vecEnd) * 0.5;
+		(g_engfuncs.pfnPointContents(vecMid) == CONTENTS_WATER ? vecEnd : vecSrc) = vecMid;
+	}
 
-		auto const C_SRC = g_engfuncs.pfnPointContents(vecSrc);
-		auto const C_MID = g_engfuncs.pfnPointContents(vecMid);
-		auto const C_END = g_engfuncs.pfnPointContents(vecEnd);
+	auto const vecSurface = (vecSrc + vecEnd) * 0.5;
 
-		if (C_SRC == C_MID && C_MID == C_END)
-			co_return;	// BAD
+	// Entering from the side, through a slope or a waterfall is not cached.
+	if (vecSrc.z > vecEnd.z && IsWaterPlane(vecSurface, vecSurface.z))
+	{
+		// Pin the height down vertically, a grazing shot leaves it loose.
+		auto flLow = vecSurface.z - 2.f, flHigh = vecSurface.z + 2.f;
 
-		if (C_SRC == C_MID && C_MID != C_END)
-		{
-			vecSrc = vecMid;
-		}
-		else if (C_SRC != C_MID && C_MID == C_END)
+		while (flHigh - flLow > 0.125f)
 		{
-			vecEnd = vecMid;
+			auto const flMid = (flLow + flHigh) * 0.5f;
+			(g_engfuncs.pfnPointContents(Vector{ vecSurface.x, vecSurface.y, flMid }) == CONTENTS_WATER ? flLow : flHigh) = flMid;
 		}
-		else
-			co_return;	// BAD
+
+		gWaterSurfaces.insert_or_assign(iColumn, (flLow + flHigh) * 0.5f);
 	}
 
-	CreateWaterSplash3D(
-		g_engfuncs.pfnPointContents(vecSrc) == CONTENTS_WATER ?
-		vecSrc : vecEnd
-	);
+	return vecSurface;
+}
+
+void ClearWaterSurfaces() noexcept
+{
+	gWaterSurfaces.clear();
+}
+
+#pragma endregion WATER
+
+static void VFX_WaterSplash(Vector const& vecSrc, Vector const& vecEnd) noexcept
+{
+	// Assume that player doesn't shooting from water,
+	// not shooting through water
+	// and not that close to the water.
+
+	assert(g_engfuncs.pfnPointContents(vecEnd) == CONTENTS_WATER);
+
+	if (g_engfuncs.pfnPointContents(vecSrc) == CONTENTS_WATER)
+		return;
 
-	co_return;
+	CreateWaterSplash3D(FindWaterSurface(vecSrc, vecEnd));
 }
 
-static Task VFX_BulletImpact(Vector const vecSrc, TraceResult const tr, char cTextureType, float flDamage) noexcept
+static Task VFX_BulletImpact(ImpactBudget::impact_t const Impact) noexcept
 {
-	// Tracer effect.
-	MsgBroadcast(SVC_TEMPENTITY);
-	WriteData(TE_TRACER);
-	WriteData(vecSrc);
-	WriteData(tr.vecEndPos);
-	MsgEnd();
+	auto const& vecSrc = Impact.m_vecSrc;
+	auto const& tr = Impact.m_tr;
+	auto const flDamage = Impact.m_flDamage;
+
+	// Tracer effect, only to the clients who can afford it.
+	for (auto bits = Impact.m_bitsTracer; bits; bits &= bits - 1)
+	{
+		g_engfuncs.pfnMessageBegin(MSG_ONE_UNRELIABLE, SVC_TEMPENTITY, nullptr, ent_cast<edict_t*>(std::countr_zero(bits) + 1));
+		g_engfuncs.pfnWriteByte(TE_TRACER);
+		g_engfuncs.pfnWriteCoord(vecSrc.x);
+		g_engfuncs.pfnWriteCoord(vecSrc.y);
+		g_engfuncs.pfnWriteCoord(vecSrc.z);
+		g_engfuncs.pfnWriteCoord(tr.vecEndPos.x);
+		g_engfuncs.pfnWriteCoord(tr.vecEndPos.y);
+		g_engfuncs.pfnWriteCoord(tr.vecEndPos.z);
+		g_engfuncs.pfnMessageEnd();
+	}
 
-	if (g_engfuncs.pfnPointContents(tr.vecEndPos) == CONTENTS_SKY)	// LUNA: I hate this so much in vanilla CS.
+	auto const iContents = g_engfuncs.pfnPointContents(tr.vecEndPos);
+
+	if (iContents == CONTENTS_SKY)	// LUNA: I hate this so much in vanilla CS.
 		co_return;
 
 	[[maybe_unused]] auto const vecDir = (tr.vecEndPos - vecSrc).Normalize();
 
 	// tr.fInWater doesn't work.
-	if (g_engfuncs.pfnPointContents(tr.vecEndPos) == CONTENTS_WATER)
-		TaskScheduler::Enroll(VFX_WaterSplash(vecSrc, tr.vecEndPos));
+	if (Impact.m_bCosmetic && iContents == CONTENTS_WATER)
+		VFX_WaterSplash(vecSrc, tr.vecEndPos);
 
 	co_await TaskScheduler::NextFrame::Rank[0];
 
-	UTIL_Decal(tr.pHit, tr.vecEndPos, UTIL_GetRandomOne(Decal::GUNSHOT));
+	if (Impact.m_bDecal)
+		UTIL_Decal(tr.pHit, tr.vecEndPos, UTIL_GetRandomOne(Decal::GUNSHOT));
 
 	co_await TaskScheduler::NextFrame::Rank[0];
 
+	auto const& Material = gMaterials[(uint8_t)Impact.m_cTextureType];
+
 	// Wall impact particles.
-	switch (cTextureType)
+	switch (Impact.m_bCosmetic ? Material.m_ImpactFx : EImpactFx::None)
 	{
-	case CHAR_TEX_FLESH:
-	case CHAR_TEX_SLOSH:
-		// Absolutely no effect on these two.
+	case EImpactFx::None:
 		break;
 
-	case CHAR_TEX_METAL:
-	case CHAR_TEX_VENT:
-	case CHAR_TEX_GRATE:
-	case CHAR_TEX_COMPUTER:
+	case EImpactFx::Sparks:
 		CreateSpark3D(tr);
 		UTIL_DLight(tr.vecEndPos, 1.f, { 255, 120, 100, }, 0.1f, 0);
 
@@ -270,30 +557,17 @@ static Task VFX_BulletImpact(Vector const vecSrc, TraceResult const tr, char cTe
 
 		break;
 
-	case CHAR_TEX_WOOD:
-		UTIL_BreakModel(
-			tr.vecEndPos, Vector(1, 1, 1) /* Invalid Arg? */, tr.vecPlaneNormal * flDamage * 2.f,
-			UTIL_Random(0.8f, 1.2f),
-			GIBS_WOOD,
-			(uint8_t)std::clamp(std::lroundf(flDamage / 4.f), 2l, 16l),
-			UTIL_Random(6.f, 9.f),
-			BREAK_WOOD
-		);
-
-		CreateWallPuff(tr);
-		break;
+	case EImpactFx::Debris:
+	{
+		auto const& Debris = *Material.m_pDebris;
 
-	case CHAR_TEX_CONCRETE:
-	case CHAR_TEX_DIRT:
-	case CHAR_TEX_TILE:
-	case CHAR_TEX_GRAVEL:
 		UTIL_BreakModel(
-			tr.vecEndPos, Vector(0.1, 0.1, 0.1) /* Invalid Arg? */, tr.vecPlaneNormal * flDamage * 2.f,
+			tr.vecEndPos, Vector(Debris.m_flSize, Debris.m_flSize, Debris.m_flSize), tr.vecPlaneNormal * flDamage * 2.f,
 			UTIL_Random(0.8f, 1.2f),
-			GIBS_CONCRETE,
+			*Debris.m_pGibs,
 			(uint8_t)std::clamp(std::lroundf(flDamage / 4.f), 2l, 16l),
 			UTIL_Random(6.f, 9.f),
-			BREAK_NONE
+			Debris.m_iFlags
 		);
 		// 1 << 0 - glass
 		// 1 << 1 - metal
@@ -305,35 +579,13 @@ static Task VFX_BulletImpact(Vector const vecSrc, TraceResult const tr, char cTe
 		// 1 << 3 - wood
 		// 9 - none
 
-		CreateWallPuff(tr);
-		break;
-
-	case CHAR_TEX_GLASS:
-		UTIL_BreakModel(
-			tr.vecEndPos, Vector(1, 1, 1) /* Invalid Arg? */, tr.vecPlaneNormal * flDamage * 2.f,
-			UTIL_Random(0.8f, 1.2f),
-			GIBS_GLASS,
-			(uint8_t)std::clamp(std::lroundf(flDamage / 4.f), 2l, 16l),
-			UTIL_Random(6.f, 9.f),
-			BREAK_GLASS | BREAK_TRANS
-		);
+		if (Debris.m_bWallPuff)
+			CreateWallPuff(tr);
 
-		CreateWallPuff(tr);
-		break;
-
-	case CHAR_TEX_GRASS_CS:
-	case CHAR_TEX_GRASS_CZ:
-		UTIL_BreakModel(
-			tr.vecEndPos, Vector(1, 1, 1) /* Invalid Arg? */, tr.vecPlaneNormal * flDamage * 2.f,
-			UTIL_Random(0.8f, 1.2f),
-			GIBS_FLORA,
-			(uint8_t)std::clamp(std::lroundf(flDamage / 4.f), 2l, 16l),
-			UTIL_Random(6.f, 9.f),
-			BREAK_NONE
-		);
 		break;
+	}
 
-	case CHAR_TEX_SNOW:
+	case EImpactFx::Snow:
 	{
 		Vector const vecFlakeDir {
 			(tr.vecEndPos + tr.vecPlaneNormal).Make2D() + vecDir.Make2D(),
@@ -365,6 +617,7 @@ static Task VFX_BulletImpact(Vector const vecSrc, TraceResult const tr, char cTe
 		break;
 	}
 
+	case EImpactFx::WallPuff:
 	default:
 		CreateWallPuff(tr);
 		break;
@@ -372,124 +625,26 @@ static Task VFX_BulletImpact(Vector const vecSrc, TraceResult const tr, char cTe
 
 	co_await TaskScheduler::NextFrame::Rank[0];
 
+	if (!Impact.m_bAudio)
+		co_return;
+
 	// Bullet impact SFX
-	switch (cTextureType)
+	// Should we add helmet and vest and flesh hurt sound here?
+	if (!Material.m_HitSounds.empty())
 	{
-	case CHAR_TEX_METAL:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_METAL),
-			0.9f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_DIRT:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_DIRT),
-			0.9f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_VENT:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_VENT),
-			0.5f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_GRATE:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_GRATE),
-			0.9f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_TILE:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_TILE),
-			0.8f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_SLOSH:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_SLOSH),
-			0.9f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_SNOW:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_SNOW),
-			0.7f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_WOOD:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_WOOD),
-			0.9f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_COMPUTER:
-	case CHAR_TEX_GLASS:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_GLASS),
-			0.8f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-		// Extentions by CZDS
-	case CHAR_TEX_CARPET:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_CARPET),
-			1.f, ATTN_STATIC, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_GRASS_CS:
-	case CHAR_TEX_GRASS_CZ:
 		g_engfuncs.pfnEmitAmbientSound(
 			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_GRASS),
-			1.f, ATTN_STATIC, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
+			UTIL_GetRandomOne(Material.m_HitSounds),
+			Material.m_flHitVolume, Material.m_flHitAttn, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
 		);
-		break;
-
-	case CHAR_TEX_GRAVEL:
-		g_engfuncs.pfnEmitAmbientSound(
-			ent_cast<edict_t*>(0), tr.vecEndPos,
-			UTIL_GetRandomOne(SFX_HIT_GRAVEL),
-			0.9f, ATTN_NORM, SND_FL_NONE, 96 + UTIL_Random(0, 0xF)
-		);
-		break;
-
-	case CHAR_TEX_FLESH:
-		// Should we add helmet and vest and flesh hurt sound here?
-
-	default:
-		break;
 	}
 
 	// ricochet sfx
 	if (UTIL_Random())
 	{
-		switch (cTextureType)
+		switch (Material.m_Ricochet)
 		{
-		case CHAR_TEX_METAL:
-		case CHAR_TEX_GRATE:
-		case CHAR_TEX_VENT:
-		case CHAR_TEX_COMPUTER:
+		case ERicochet::Metal:
 			g_engfuncs.pfnEmitAmbientSound(
 				ent_cast<edict_t*>(0), tr.vecEndPos,
 				UTIL_GetRandomOne(SFX_RICO_METAL),
@@ -498,11 +653,10 @@ static Task VFX_BulletImpact(Vector const vecSrc, TraceResult const tr, char cTe
 			break;
 
 			// Soft surfaces.
-		case CHAR_TEX_FLESH:
-		case CHAR_TEX_SLOSH:
-		case CHAR_TEX_SNOW:
+		case ERicochet::None:
 			break;
 
+		case ERicochet::Generic:
 		default:
 			g_engfuncs.pfnEmitAmbientSound(
 				ent_cast<edict_t*>(0), tr.vecEndPos,
@@ -514,114 +668,120 @@ static Task VFX_BulletImpact(Vector const vecSrc, TraceResult const tr, char cTe
 	}
 }
 
-// Go to the trouble of combining multiple pellets into a single damage call.
-// This version is used by Players, uses the random seed generator to sync client and server side shots.
-Vector2D CS_FireBullets3(
-	CBasePlayer* pAttacker, CBasePlayerItem* pInflictor,
-	Vector const& vecSrcOfs, float flSpread, float flDistance,
-	int iPenetration, CAmmoInfo const* pAmmoInfo, float flDamage, float flRangeModifier) noexcept
+// Worst case bytes of the sounds and of the cosmetics an impact on this material sends.
+static std::pair<std::size_t, std::size_t> ImpactCost(material_t const& Material) noexcept
 {
-	[[maybe_unused]] auto const iOriginalPenetration{ iPenetration };
-	float flPenetrationPower{ (float)pAmmoInfo->m_iPenetrationPower };
-	float const flPenetrationDistance{ (float)pAmmoInfo->m_iPenetrationDistance };
-	auto flCurDmg{ flDamage };
-	float flCurrentDistance{};
-	TraceResult tr{};
+	std::size_t iAudio = Material.m_HitSounds.empty() ? 0 : SOUND_MSG_SIZE;
+	iAudio += Material.m_Ricochet == ERicochet::None ? 0 : SOUND_MSG_SIZE;
 
-	auto const [vecForward, vecRight, vecUp]
-		= (pAttacker->pev->v_angle + pAttacker->pev->punchangle).AngleVectors();
+	switch (Material.m_ImpactFx)
+	{
+	case EImpactFx::None:
+		return { iAudio, 0 };
 
-	// Penetration data was moved into struct CAmmoInfo
+	case EImpactFx::Sparks:
+		return { iAudio, ENTITY_SPAWN_SIZE + DLIGHT_MSG_SIZE + STREAK_MSG_SIZE };
 
-	gpMultiDamage->type = (DMG_BULLET | DMG_NEVERGIB);
+	case EImpactFx::Debris:
+		return { iAudio, BREAKMODEL_MSG_SIZE + (Material.m_pDebris->m_bWallPuff ? ENTITY_SPAWN_SIZE : 0) };
 
-	float x{}, y{}, z{};
+	case EImpactFx::Snow:
+		return { iAudio, SPRITETRAIL_MSG_SIZE + ENTITY_SPAWN_SIZE * 2 };
 
-	if (pAttacker->IsPlayer())	[[likely]]
-	{
-		// Use player's random seed.
-		// get circular gaussian spread
-		x = Uranus::UTIL_SharedRandomFloat{}(pAttacker->random_seed, -0.5, 0.5) + Uranus::UTIL_SharedRandomFloat{}(pAttacker->random_seed + 1, -0.5, 0.5);
-		y = Uranus::UTIL_SharedRandomFloat{}(pAttacker->random_seed + 2, -0.5, 0.5) + Uranus::UTIL_SharedRandomFloat{}(pAttacker->random_seed + 3, -0.5, 0.5);
-	}
-	else
-	{
-		do
-		{
-			x = UTIL_Random(-0.5f, 0.5f) + UTIL_Random(-0.5f, 0.5f);
-			y = UTIL_Random(-0.5f, 0.5f) + UTIL_Random(-0.5f, 0.5f);
-			z = x * x + y * y;
-		} while (z > 1);
+	case EImpactFx::WallPuff:
+	default:
+		return { iAudio, ENTITY_SPAWN_SIZE };
 	}
+}
 
-	auto vecSrc = pAttacker->GetGunPosition();
-	auto const vecDir = vecForward + x * flSpread * vecRight + y * flSpread * vecUp;
-	auto vecEnd = vecSrc + vecDir * flDistance;
+static void QueueImpact(Vector const& vecSrc, TraceResult const& tr, char cTextureType, float flDamage) noexcept
+{
+	auto const [iAudioCost, iCosmeticCost] = ImpactCost(gMaterials[(uint8_t)cTextureType]);
 
-	float flDamageModifier = 0.5f;
+	ImpactBudget::Queue(vecSrc, tr, cTextureType, flDamage, iAudioCost, iCosmeticCost);
+}
 
-	while (iPenetration != 0)
-	{
-		Uranus::ClearMultiDamage{}();
-		g_engfuncs.pfnTraceLine(vecSrc, vecEnd, dont_ignore_glass | dont_ignore_monsters, pAttacker->edict(), &tr);
+// Called once per frame. Everything hit since the last call is merged, budgeted per client and played.
+void FlushImpacts() noexcept
+{
+	if (ImpactBudget::m_Pending.empty())
+		return;
 
-		if (ZBot::Manager() && tr.flFraction != 1.0f)
-			ZBot::Manager()->OnEvent(EVENT_BULLET_IMPACT, pAttacker, (CBaseEntity*)&tr.vecEndPos);
+	static std::vector<ImpactBudget::viewer_t> Viewers{};
+	Viewers.clear();
 
-		char cTextureType = Uranus::UTIL_TextureHit{}(&tr, vecSrc, vecEnd);
-		[[maybe_unused]] bool bSparks{}, bHitMetal{};
+	auto const iMaxClients = std::min(gpGlobals->maxClients, 32);
 
-		switch (cTextureType)
-		{
-		case CHAR_TEX_METAL:
-			bHitMetal = true;
-			bSparks = true;
+	for (int iIndex = 1; iIndex <= iMaxClients; ++iIndex)
+	{
+		auto const pPlayer = ent_cast<CBasePlayer*>(iIndex);
 
-			flPenetrationPower *= 0.15f;
-			flDamageModifier = 0.2f;
-			break;
+		if (!pPlayer || pPlayer->IsDormant() || pPlayer->IsBot())
+			continue;
 
-		case CHAR_TEX_CONCRETE:
-			flPenetrationPower *= 0.25f;
-			break;
+		auto const [vecForward, vecRight, vecUp] = pPlayer->pev->v_angle.AngleVectors();
 
-		case CHAR_TEX_GRATE:
-			bHitMetal = true;
-			bSparks = true;
+		Viewers.emplace_back(ImpactBudget::viewer_t{
+			.m_vecEye{ pPlayer->pev->origin + pPlayer->pev->view_ofs },
+			.m_vecForward{ vecForward },
+			.m_iSlot{ (uint8_t)(iIndex - 1) },
+		});
+	}
 
-			flPenetrationPower *= 0.5f;
-			flDamageModifier = 0.4f;
-			break;
+	ImpactBudget::Plan(Viewers);
 
-		case CHAR_TEX_VENT:
-			bHitMetal = true;
-			bSparks = true;
+	for (auto&& Impact : ImpactBudget::m_Pending)
+		TaskScheduler::Enroll(VFX_BulletImpact(Impact));
 
-			flPenetrationPower *= 0.5f;
-			flDamageModifier = 0.45f;
-			break;
+	ImpactBudget::m_Pending.clear();
+}
 
-		case CHAR_TEX_TILE:
-			flPenetrationPower *= 0.65f;
-			flDamageModifier = 0.3f;
-			break;
+struct bullet_hit_t final
+{
+	CBaseEntity* m_pEntity{};
+	float m_flDamage{};
+	Vector m_vecDir{};
+	TraceResult m_tr{};
+};
 
-		case CHAR_TEX_COMPUTER:
-			bHitMetal = true;
-			bSparks = true;
+// Hits of the shot being fired, applied victim by victim once every pellet is traced.
+static std::vector<bullet_hit_t> gBulletHits{};
 
-			flPenetrationPower *= 0.4f;
-			flDamageModifier = 0.45f;
-			break;
+// One pellet, from the muzzle through whatever it can penetrate.
+// Hits are kept in gBulletHits for the caller, the impacts go into the end of frame queue.
+static void FireBullet(
+	CBasePlayer* pAttacker, Vector vecSrc, Vector const& vecDir, float flDistance,
+	int iPenetration, CAmmoInfo const* pAmmoInfo, float flDamage, float flRangeModifier, bool& bBotNotified) noexcept
+{
+	float flPenetrationPower{ (float)pAmmoInfo->m_iPenetrationPower };
+	float const flPenetrationDistance{ (float)pAmmoInfo->m_iPenetrationDistance };
+	auto flCurDmg{ flDamage };
+	float flCurrentDistance{};
+	TraceResult tr{};
 
-		case CHAR_TEX_WOOD:
-			flDamageModifier = 0.6f;
-			break;
+	auto vecEnd = vecSrc + vecDir * flDistance;
 
-		default:
-			break;
+	float flDamageModifier = 0.5f;
+
+	while (iPenetration != 0)
+	{
+		g_engfuncs.pfnTraceLine(vecSrc, vecEnd, dont_ignore_glass | dont_ignore_monsters, pAttacker->edict(), &tr);
+
+		// Bots only need to hear where the shot went, not every pellet of it.
+		if (!bBotNotified && ZBot::Manager() && tr.flFraction != 1.0f)
+		{
+			ZBot::Manager()->OnEvent(EVENT_BULLET_IMPACT, pAttacker, (CBaseEntity*)&tr.vecEndPos);
+			bBotNotified = true;
 		}
 
+		char cTextureType = TextureCache::Hit(&tr, vecSrc, vecEnd);
+		auto const& Material = gMaterials[(uint8_t)cTextureType];
+
+		flPenetrationPower *= Material.m_flPenetrationPower;
+
+		if (Material.m_flDamageModifier)
+			flDamageModifier = *Material.m_flDamageModifier;
+
 		if (tr.flFraction != 1.0f)
 		{
 			CBaseEntity* pEntity = ent_cast<CBaseEntity*>(tr.pHit);
@@ -667,14 +827,14 @@ Vector2D CS_FireBullets3(
 			else
 				flDistanceModifier = 0.5f;
 
-			TaskScheduler::Enroll(VFX_BulletImpact(vecSrc, tr, cTextureType, flCurDmg));
+			QueueImpact(vecSrc, tr, cTextureType, flCurDmg);
 
 			[[maybe_unused]] auto const vecPrevSrc{ vecSrc }, vecPrevEndpos{ tr.vecEndPos - vecDir * flPenetrationPower };
 			vecSrc = tr.vecEndPos + (vecDir * flPenetrationPower);
 			flDistance = (flDistance - flCurrentDistance) * flDistanceModifier;
 			vecEnd = vecSrc + (vecDir * flDistance);
 
-			pEntity->TraceAttack(pAttacker->pev, flCurDmg, vecDir, &tr, (DMG_BULLET | DMG_NEVERGIB));
+			gBulletHits.emplace_back(pEntity, flCurDmg, vecDir, tr);
 			flCurDmg *= flDamageModifier;
 
 			// Trace back, such that we can place a bullet hole on the opposite side of the wall as well.
@@ -682,18 +842,76 @@ Vector2D CS_FireBullets3(
 			{
 				g_engfuncs.pfnTraceLine(vecPrevEndpos, vecPrevSrc, dont_ignore_glass | dont_ignore_monsters, pAttacker->edict(), &tr);
 				if (!tr.fAllSolid && tr.fInOpen && tr.flFraction != 1)
-					TaskScheduler::Enroll(VFX_BulletImpact(vecPrevEndpos, tr, cTextureType, flCurDmg));
+					QueueImpact(vecPrevEndpos, tr, cTextureType, flCurDmg);
 			}
 		}
 		else
 			// We exceed the bullet traveling limitation.
 			iPenetration = 0;
+	}
+}
+
+// Go to the trouble of combining multiple pellets into a single damage call.
+// This version is used by Players, uses the random seed generator to sync client and server side shots.
+// Every pellet shares the view vectors and the muzzle, every victim takes its damage once; the impacts are flushed together at the end of frame.
+// Returns the spread of the first pellet.
+Vector2D CS_FireBullets3(
+	CBasePlayer* pAttacker, CBasePlayerItem* pInflictor,
+	Vector const& vecSrcOfs, float flSpread, float flDistance,
+	int iPenetration, CAmmoInfo const* pAmmoInfo, float flDamage, float flRangeModifier, int iPellets) noexcept
+{
+	auto const [vecForward, vecRight, vecUp]
+		= (pAttacker->pev->v_angle + pAttacker->pev->punchangle).AngleVectors();
+
+	// Penetration data was moved into struct CAmmoInfo
 
-		Uranus::ApplyMultiDamage{}(pInflictor->pev, pAttacker->pev);
+	auto const vecSrc = pAttacker->GetGunPosition();
+	bool bBotNotified = false;
+	Vector2D vecFirstSpread{};
+
+	gBulletHits.clear();
+
+	for (int iShot = 0; iShot < iPellets; ++iShot)
+	{
+		float x{}, y{}, z{};
+
+		if (pAttacker->IsPlayer())	[[likely]]
+		{
+			// Use player's random seed.
+			// get circular gaussian spread
+			// Each pellet slides the seed by one, same as HLSDK FireBulletsPlayer(). The first pellet is unchanged.
+			x = Uranus::UTIL_SharedRandomFloat{}(pAttacker->random_seed + iShot, -0.5, 0.5) + Uranus::UTIL_SharedRandomFloat{}(pAttacker->random_seed + 1 + iShot, -0.5, 0.5);
+			y = Uranus::UTIL_SharedRandomFloat{}(pAttacker->random_seed + 2 + iShot, -0.5, 0.5) + Uranus::UTIL_SharedRandomFloat{}(pAttacker->random_seed + 3 + iShot, -0.5, 0.5);
+		}
+		else
+		{
+			do
+			{
+				x = UTIL_Random(-0.5f, 0.5f) + UTIL_Random(-0.5f, 0.5f);
+				y = UTIL_Random(-0.5f, 0.5f) + UTIL_Random(-0.5f, 0.5f);
+				z = x * x + y * y;
+			} while (z > 1);
+		}
+
+		auto const vecDir = vecForward + x * flSpread * vecRight + y * flSpread * vecUp;
+
+		FireBullet(pAttacker, vecSrc, vecDir, flDistance, iPenetration, pAmmoInfo, flDamage, flRangeModifier, bBotNotified);
+
+		if (iShot == 0)
+			vecFirstSpread = Vector2D{ x * flSpread, y * flSpread };
 	}
 
-	return Vector2D{
-		x * flSpread,
-		y * flSpread,
-	};
+	// Multi-damage only adds up consecutive hits on the same entity.
+	// Line them up by victim, so each one takes a single TakeDamage() no matter how the pellets interleaved.
+	std::ranges::stable_sort(gBulletHits, {}, &bullet_hit_t::m_pEntity);
+
+	gpMultiDamage->type = (DMG_BULLET | DMG_NEVERGIB);
+	Uranus::ClearMultiDamage{}();
+
+	for (auto&& Hit : gBulletHits)
+		Hit.m_pEntity->TraceAttack(pAttacker->pev, Hit.m_flDamage, Hit.m_vecDir, &Hit.m_tr, (DMG_BULLET | DMG_NEVERGIB));
+
+	Uranus::ApplyMultiDamage{}(pInflictor->pev, pAttacker->pev);
+
+	return vecFirstSpread;
 }
@@ -0,0 +1,234 @@
+export module ImpactBudget;
+
+import std;
+import hlsdk;
+
+
+
+// Wire cost estimates of what one bullet impact may send, svc byte included.
+export inline constexpr std::size_t TRACER_MSG_SIZE = 1 + 1 + 6 * 2;
+export inline constexpr std::size_t DECAL_MSG_SIZE = 1 + 1 + 3 * 2 + 1 + 2;
+export inline constexpr std::size_t STREAK_MSG_SIZE = 1 + 1 + 6 * 2 + 1 + 3 * 2;
+export inline constexpr std::size_t SPRITETRAIL_MSG_SIZE = 1 + 1 + 6 * 2 + 2 + 5;
+export inline constexpr std::size_t BREAKMODEL_MSG_SIZE = 1 + 1 + 9 * 2 + 1 + 2 + 3;
+export inline constexpr std::size_t DLIGHT_MSG_SIZE = 1 + 1 + 3 * 2 + 6;
+export inline constexpr std::size_t SOUND_MSG_SIZE = 1 + 1 + 3 * 2 + 2 + 2 + 2;	// svc_spawnstaticsound
+export inline constexpr std::size_t ENTITY_SPAWN_SIZE = 24;	// first delta of a fresh effect entity, roughly.
+
+export namespace ImpactBudget
+{
+	// Temp entity bytes each client may receive from bullet impacts in a single frame.
+	inline constexpr std::size_t BYTES_PER_CLIENT_FRAME = 400;
+
+	// Impacts on the same surface closer than this are folded into one.
+	inline constexpr float MERGE_DIST = 8.f;
+
+	// Clients farther than this are not expected to see, nor pay for, broadcasted impact effects.
+	inline constexpr float RELEVANT_DIST = 2048.f;
+
+	// cos() of the half angle a client is assumed to be looking at.
+	inline constexpr float VIEW_CONE_COS = 0.5f;
+
+	// Impacts behind the client rank as if they were this many times farther, in squared units.
+	inline constexpr float OUT_OF_VIEW_PENALTY = 4.f;
+
+	struct impact_t
+	{
+		Vector m_vecSrc{};
+		TraceResult m_tr{};
+		char m_cTextureType{};
+		float m_flDamage{};	// summed over every merged hit, for a stronger effect
+		std::uint16_t m_iAudioCost{};
+		std::uint16_t m_iCosmeticCost{};
+
+		// Filled by Plan()
+		std::uint32_t m_bitsTracer{};	// client slots (index - 1) receiving the tracer
+		bool m_bDecal{};
+		bool m_bAudio{};
+		bool m_bCosmetic{};
+	};
+
+	struct viewer_t
+	{
+		Vector m_vecEye{};
+		Vector m_vecForward{};
+		std::uint8_t m_iSlot{};	// index - 1
+	};
+
+	struct stats_t
+	{
+		std::size_t m_iQueued{};
+		std::size_t m_iMerged{};
+		std::size_t m_iPlanned{};
+		std::size_t m_iDecalsDropped{};
+		std::size_t m_iTracersDropped{};	// counted per client
+		std::size_t m_iAudioDropped{};
+		std::size_t m_iCosmeticDropped{};
+		std::size_t m_iPeakBytes{};	// worst client in a single frame
+		std::array<std::size_t, 32> m_rgiLastBytes{};	// per client, from the last non-empty frame
+	};
+
+	inline stats_t m_Stats{};
+	inline std::vector<impact_t> m_Pending{};
+}
+
+inline std::vector<float> m_Scores{};	// [viewer * impacts + impact], lower is more important
+inline std::vector<float> m_Priority{};	// best score of each impact across all viewers
+inline std::vector<std::uint32_t> m_Relevant{};	// client slots near each impact
+inline std::vector<std::size_t> m_Order{};
+
+// All relevant clients must afford it, otherwise nobody gets it.
+// Broadcasted messages cannot be withheld from a single client.
+[[nodiscard]] inline bool TryCharge(std::array<std::size_t, 32>& rgiSpent, std::uint32_t bitsClients, std::size_t iCost) noexcept
+{
+	for (auto bits = bitsClients; bits; bits &= bits - 1)
+	{
+		if (rgiSpent[std::countr_zero(bits)] + iCost > ImpactBudget::BYTES_PER_CLIENT_FRAME)
+			return false;
+	}
+
+	for (auto bits = bitsClients; bits; bits &= bits - 1)
+		rgiSpent[std::countr_zero(bits)] += iCost;
+
+	return true;
+}
+
+export namespace ImpactBudget
+{
+	// Buffer a hit until the end of frame. Nearby hits on the same surface with the same material fold into one.
+	void Queue(Vector const& vecSrc, TraceResult const& tr, char cTextureType, float flDamage, std::size_t iAudioCost, std::size_t iCosmeticCost) noexcept
+	{
+		++m_Stats.m_iQueued;
+
+		for (auto&& Impact : m_Pending)
+		{
+			if (Impact.m_tr.pHit != tr.pHit || Impact.m_cTextureType != cTextureType)
+				continue;
+
+			if ((Impact.m_tr.vecEndPos - tr.vecEndPos).LengthSquared() > MERGE_DIST * MERGE_DIST)
+				continue;
+
+			if (DotProduct(Impact.m_tr.vecPlaneNormal, tr.vecPlaneNormal) < 0.9f)
+				continue;
+
+			Impact.m_flDamage += flDamage;
+
+			++m_Stats.m_iMerged;
+			return;
+		}
+
+		m_Pending.emplace_back(impact_t{
+			.m_vecSrc{ vecSrc },
+			.m_tr{ tr },
+			.m_cTextureType{ cTextureType },
+			.m_flDamage{ flDamage },
+			.m_iAudioCost{ (std::uint16_t)iAudioCost },
+			.m_iCosmeticCost{ (std::uint16_t)iCosmeticCost },
+		});
+	}
+
+	// Decide what every pending impact may send, no client is charged past BYTES_PER_CLIENT_FRAME.
+	// Decals come first, then tracers are handed per client by distance and view,
+	// then sounds, then the cosmetics; so gibs and sparks are the first to be dropped.
+	void Plan(std::span<viewer_t const> Viewers) noexcept
+	{
+		auto const N = m_Pending.size();
+
+		if (!N)
+			return;
+
+		std::array<std::size_t, 32> rgiSpent{};
+		std::uint32_t bitsViewers{};
+
+		m_Scores.assign(Viewers.size() * N, 0.f);
+		m_Priority.assign(N, std::numeric_limits<float>::max());
+		m_Relevant.assign(N, 0);
+
+		for (auto&& [v, Viewer] : Viewers | std::views::enumerate)
+		{
+			auto const bit = 1u << Viewer.m_iSlot;
+			bitsViewers |= bit;
+
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				auto const vecDelta = m_Pending[i].m_tr.vecEndPos - Viewer.m_vecEye;
+				auto const flDistSq = vecDelta.LengthSquared();
+				auto const bInView = DotProduct(vecDelta, Viewer.m_vecForward) >= VIEW_CONE_COS * std::sqrt(flDistSq);
+				auto const flScore = bInView ? flDistSq : flDistSq * OUT_OF_VIEW_PENALTY;
+
+				m_Scores[(std::size_t)v * N + i] = flScore;
+				m_Priority[i] = std::min(m_Priority[i], flScore);
+
+				if (flDistSq < RELEVANT_DIST * RELEVANT_DIST)
+					m_Relevant[i] |= bit;
+			}
+		}
+
+		m_Order.resize(N);
+		std::ranges::iota(m_Order, 0);
+		std::ranges::sort(m_Order, {}, [](std::size_t i) noexcept { return m_Priority[i]; });
+
+		// Decals are broadcasted, everyone pays for them.
+		for (auto&& i : m_Order)
+		{
+			auto& Impact = m_Pending[i];
+			Impact.m_bitsTracer = 0;
+			Impact.m_bDecal = TryCharge(rgiSpent, bitsViewers, DECAL_MSG_SIZE);
+
+			if (!Impact.m_bDecal)
+				++m_Stats.m_iDecalsDropped;
+		}
+
+		for (auto&& [v, Viewer] : Viewers | std::views::enumerate)
+		{
+			auto const Scores = std::span{ m_Scores }.subspan((std::size_t)v * N, N);
+			auto& iSpent = rgiSpent[Viewer.m_iSlot];
+
+			std::ranges::iota(m_Order, 0);
+			std::ranges::sort(m_Order, {}, [&](std::size_t i) noexcept { return Scores[i]; });
+
+			for (auto&& i : m_Order)
+			{
+				if (iSpent + TRACER_MSG_SIZE > BYTES_PER_CLIENT_FRAME)
+				{
+					++m_Stats.m_iTracersDropped;
+					continue;
+				}
+
+				iSpent += TRACER_MSG_SIZE;
+				m_Pending[i].m_bitsTracer |= 1u << Viewer.m_iSlot;
+			}
+		}
+
+		std::ranges::iota(m_Order, 0);
+		std::ranges::sort(m_Order, {}, [](std::size_t i) noexcept { return m_Priority[i]; });
+
+		for (auto&& i : m_Order)
+		{
+			auto& Impact = m_Pending[i];
+			Impact.m_bAudio = !Impact.m_iAudioCost || TryCharge(rgiSpent, m_Relevant[i], Impact.m_iAudioCost);
+
+			if (!Impact.m_bAudio)
+				++m_Stats.m_iAudioDropped;
+		}
+
+		for (auto&& i : m_Order)
+		{
+			auto& Impact = m_Pending[i];
+			Impact.m_bCosmetic = !Impact.m_iCosmeticCost || TryCharge(rgiSpent, m_Relevant[i], Impact.m_iCosmeticCost);
+
+			if (!Impact.m_bCosmetic)
+				++m_Stats.m_iCosmeticDropped;
+		}
+
+		m_Stats.m_iPlanned += N;
+		m_Stats.m_rgiLastBytes = rgiSpent;
+		m_Stats.m_iPeakBytes = std::max(m_Stats.m_iPeakBytes, std::ranges::max(rgiSpent));
+	}
+
+	// Drop whatever is pending, e.g. on map change where the hit entities are gone.
+	void Clear() noexcept
+	{
+		m_Pending.clear();
+	}
+}
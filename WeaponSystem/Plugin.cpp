@@ -8,6 +8,7 @@ import Task;
 import Uranus;
 
 import Plugin;
+import Profiler;
 
 
 // DllFunc.cpp
@@ -15,10 +16,13 @@ extern void fw_GameInit_Post() noexcept;
 extern void fw_GameShutdown_Post() noexcept;
 extern void fw_ServerActivate_Post(edict_t* pEdictList, int edictCount, int clientMax) noexcept;
 extern void fw_ServerDeactivate_Post() noexcept;
+extern void fw_StartFrame_Post() noexcept;
 extern auto fw_Spawn(edict_t* pEdict) noexcept -> qboolean;
 extern void fw_UpdateClientData_Post(const edict_t* ent, qboolean sendweapons, clientdata_t* cd) noexcept;
 extern void fw_OnFreeEntPrivateData(edict_t* pEnt) noexcept;
 extern auto fw_ShouldCollide(edict_t* pentTouched, edict_t* pentOther) noexcept -> qboolean;
+extern void fw_TraceLine(const float* v1, const float* v2, int fNoMonsters, edict_t* pentToSkip, TraceResult* ptr) noexcept;
+extern void fw_MessageBegin(int msg_dest, int msg_type, const float* pOrigin, edict_t* ed) noexcept;
 //
 
 // DllFunc.Command.cpp
@@ -33,16 +37,47 @@ extern qboolean fw_AddToFullPack_Post(entity_state_t* pState, int iEntIndex, edi
 //
 
 // Effect.cpp
-extern void Effect_AddToFullPack_Post(entity_state_t* pState, edict_t* pEdict, edict_t* pClientSendTo, bool bIsPlayer) noexcept;
+extern void Effect_AddToFullPack_Post(entity_state_t* pState, int iEntIndex, edict_t* pClientSendTo, bool bIsPlayer) noexcept;
 //
 
 
+// Metamod never routes our own g_engfuncs calls through fw_TraceLine() and fw_MessageBegin(), those only see the game dll.
+// So when profiling, our copy of the table counts on the way to the engine instead.
+static decltype(enginefuncs_t::pfnTraceLine) gpfnTraceLine = nullptr;
+static decltype(enginefuncs_t::pfnTraceTexture) gpfnTraceTexture = nullptr;
+static decltype(enginefuncs_t::pfnMessageBegin) gpfnMessageBegin = nullptr;
+
+static void prof_TraceLine(const float* v1, const float* v2, int fNoMonsters, edict_t* pentToSkip, TraceResult* ptr) noexcept
+{
+	Profiler::OnTraceLine();
+	gpfnTraceLine(v1, v2, fNoMonsters, pentToSkip, ptr);
+}
+
+static auto prof_TraceTexture(edict_t* pTextureEntity, const float* v1, const float* v2) noexcept -> const char*
+{
+	Profiler::OnTraceLine();
+	return gpfnTraceTexture(pTextureEntity, v1, v2);
+}
+
+static void prof_MessageBegin(int msg_dest, int msg_type, const float* pOrigin, edict_t* ed) noexcept
+{
+	Profiler::OnMessageBegin();
+	gpfnMessageBegin(msg_dest, msg_type, pOrigin, ed);
+}
+
 // Receive engine function table from engine.
 // This appears to be the _first_ DLL routine called by the engine, so we do some setup operations here.
 void __stdcall GiveFnptrsToDll(enginefuncs_t *pengfuncsFromEngine, globalvars_t *pGlobals) noexcept
 {
 	std::memcpy(&g_engfuncs, pengfuncsFromEngine, sizeof(enginefuncs_t));
 	gpGlobals = pGlobals;
+
+	if constexpr (Profiler::ENABLED)
+	{
+		gpfnTraceLine = std::exchange(g_engfuncs.pfnTraceLine, &prof_TraceLine);
+		gpfnTraceTexture = std::exchange(g_engfuncs.pfnTraceTexture, &prof_TraceTexture);
+		gpfnMessageBegin = std::exchange(g_engfuncs.pfnMessageBegin, &prof_MessageBegin);
+	}
 }
 
 static int HookGameDLLExportedFn(DLL_FUNCTIONS *pFunctionTable, int *interfaceVersion) noexcept
@@ -163,7 +198,7 @@ static int HookGameDLLExportedFn_Post(DLL_FUNCTIONS *pFunctionTable, int *interf
 		.pfnPlayerPreThink			= nullptr,
 		.pfnPlayerPostThink			= nullptr,
 
-		.pfnStartFrame				= &TaskScheduler::Think,
+		.pfnStartFrame				= &fw_StartFrame_Post,
 		.pfnParmsNewLevel			= nullptr,
 		.pfnParmsChangeLevel		= nullptr,
 
@@ -182,7 +217,7 @@ static int HookGameDLLExportedFn_Post(DLL_FUNCTIONS *pFunctionTable, int *interf
 
 		.pfnSetupVisibility			= nullptr,
 		.pfnUpdateClientData		= &fw_UpdateClientData_Post,
-		.pfnAddToFullPack			= [](entity_state_t* pState, int iEntIndex, edict_t* pEdict, edict_t* pClientSendTo, qboolean cl_lw, qboolean bIsPlayer, unsigned char* pSet) noexcept -> qboolean { fw_AddToFullPack_Post(pState, iEntIndex, pEdict, pClientSendTo, cl_lw, bIsPlayer, pSet); Effect_AddToFullPack_Post(pState, pEdict, pClientSendTo, bIsPlayer); return false; },
+		.pfnAddToFullPack			= [](entity_state_t* pState, int iEntIndex, edict_t* pEdict, edict_t* pClientSendTo, qboolean cl_lw, qboolean bIsPlayer, unsigned char* pSet) noexcept -> qboolean { fw_AddToFullPack_Post(pState, iEntIndex, pEdict, pClientSendTo, cl_lw, bIsPlayer, pSet); Effect_AddToFullPack_Post(pState, iEntIndex, pClientSendTo, bIsPlayer); return false; },
 		.pfnCreateBaseline			= nullptr,
 		.pfnRegisterEncoders		= nullptr,
 		.pfnGetWeaponData			= nullptr,
@@ -315,7 +350,7 @@ static int HookEngineAPI(enginefuncs_t *pengfuncsFromEngine, int *interfaceVersi
 		.pfnEmitSound						= nullptr,
 		.pfnEmitAmbientSound				= nullptr,
 
-		.pfnTraceLine						= nullptr,
+		.pfnTraceLine						= Profiler::ENABLED ? &fw_TraceLine : nullptr,
 		.pfnTraceToss						= nullptr,
 		.pfnTraceMonsterHull				= nullptr,
 		.pfnTraceHull						= nullptr,
@@ -333,7 +368,7 @@ static int HookEngineAPI(enginefuncs_t *pengfuncsFromEngine, int *interfaceVersi
 		.pfnDecalIndex						= nullptr,
 		.pfnPointContents					= nullptr,
 
-		.pfnMessageBegin					= nullptr,
+		.pfnMessageBegin					= Profiler::ENABLED ? &fw_MessageBegin : nullptr,
 		.pfnMessageEnd						= nullptr,
 
 		.pfnWriteByte						= nullptr,
@@ -0,0 +1,339 @@
+export module Profiler;
+
+import std;
+
+
+
+export namespace Profiler
+{
+	// Debug builds, or define WSIV_PROFILE. Otherwise every scope below is an empty struct.
+#if defined(_DEBUG) || defined(WSIV_PROFILE)
+	inline constexpr bool ENABLED = true;
+#else
+	inline constexpr bool ENABLED = false;
+#endif
+
+	enum EStage : std::uint8_t
+	{
+		STAGE_SHOT,	// Whole unit opened by shot_t, the one traces and messages are counted against.
+		STAGE_ITEM_POST_FRAME,	// Scheduler think of a weapon in hand.
+		STAGE_QC_EVENTS,
+		STAGE_QC_SCRIPT,
+		STAGE_FIRE_BULLETS,
+		STAGE_BULLET_IMPACT,
+		STAGE_EFFECTS,
+
+		STAGE_COUNT,
+	};
+
+	inline constexpr std::array<std::string_view, STAGE_COUNT> STAGE_NAMES =
+	{
+		"shot",
+		"item_post_frame",
+		"qc_events",
+		"qc_script",
+		"fire_bullets",
+		"bullet_impact",
+		"effects",
+	};
+
+	// Samples a thread may hold between two Flush(). Beyond this they are dropped and counted.
+	inline constexpr std::size_t RING_SIZE = 4096;
+
+	// Log-linear buckets: 2^SUB_BITS per power of two, i.e. within 1/8 of the true value.
+	inline constexpr std::size_t SUB_BITS = 3;
+	inline constexpr std::size_t SUB_BUCKETS = 1 << SUB_BITS;
+	inline constexpr std::size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+	struct histogram_t
+	{
+		std::array<std::uint32_t, BUCKETS> m_Counts{};
+		std::uint64_t m_iCount{};
+		std::uint64_t m_iSum{};
+		std::uint64_t m_iMax{};
+
+		// Values below SUB_BUCKETS get a bucket of their own, then each power of two is split SUB_BUCKETS ways.
+		[[nodiscard]] static constexpr std::size_t Bucket(std::uint64_t iValue) noexcept
+		{
+			if (iValue < SUB_BUCKETS)
+				return (std::size_t)iValue;
+
+			auto const iExp = (std::size_t)std::bit_width(iValue) - 1;
+			auto const iSub = (std::size_t)(iValue >> (iExp - SUB_BITS)) & (SUB_BUCKETS - 1);
+
+			return (iExp - SUB_BITS + 1) * SUB_BUCKETS + iSub;
+		}
+
+		// Smallest value landing in the bucket.
+		[[nodiscard]] static constexpr std::uint64_t BucketFloor(std::size_t iBucket) noexcept
+		{
+			if (iBucket < SUB_BUCKETS)
+				return iBucket;
+
+			auto const iExp = iBucket / SUB_BUCKETS + SUB_BITS - 1;
+			auto const iSub = (std::uint64_t)(iBucket % SUB_BUCKETS);
+
+			return (1ull << iExp) | (iSub << (iExp - SUB_BITS));
+		}
+
+		void Add(std::uint64_t iValue) noexcept
+		{
+			++m_Counts[Bucket(iValue)];
+			++m_iCount;
+			m_iSum += iValue;
+			m_iMax = std::max(m_iMax, iValue);
+		}
+
+		// Nearest rank, reported as the floor of its bucket and never beyond the largest value seen.
+		[[nodiscard]] std::uint64_t Percentile(double flPercent) const noexcept
+		{
+			if (!m_iCount)
+				return 0;
+
+			auto const iRank = std::max<std::uint64_t>(1, (std::uint64_t)std::ceil(flPercent / 100.0 * (double)m_iCount));
+			std::uint64_t iSeen{};
+
+			for (std::size_t i = 0; i < BUCKETS; ++i)
+			{
+				iSeen += m_Counts[i];
+
+				if (iSeen >= iRank)
+					return std::min(BucketFloor(i), m_iMax);
+			}
+
+			return m_iMax;
+		}
+
+		[[nodiscard]] double Mean() const noexcept { return m_iCount ? (double)m_iSum / (double)m_iCount : 0.0; }
+	};
+
+	// Everything measured for one weapon class, or any other name handed to ClassIndex().
+	struct record_t
+	{
+		std::array<histogram_t, STAGE_COUNT> m_Stages{};	// nanoseconds
+		histogram_t m_Traces{};	// per shot
+		histogram_t m_Messages{};	// per shot
+	};
+
+	struct sample_t
+	{
+		std::uint32_t m_iNanoSec{};
+		std::uint16_t m_iClass{};
+		EStage m_iStage{};
+		std::uint16_t m_iTraces{};	// STAGE_SHOT only
+		std::uint16_t m_iMessages{};	// STAGE_SHOT only
+	};
+
+	// Written by the thread doing the work, drained into the records by Flush() from the same thread.
+	struct ring_t
+	{
+		std::array<sample_t, RING_SIZE> m_Samples{};
+		std::size_t m_iCount{};
+		std::size_t m_iDropped{};
+
+		// The shot being measured on this thread, if any.
+		bool m_bInShot{};
+		std::uint32_t m_iTraces{};
+		std::uint32_t m_iMessages{};
+
+		void Push(sample_t const& Sample) noexcept
+		{
+			if (m_iCount < RING_SIZE)
+				m_Samples[m_iCount++] = Sample;
+			else
+				++m_iDropped;
+		}
+	};
+
+	inline thread_local ring_t m_Ring{};
+
+	inline std::vector<std::string> m_Classes{};
+	inline std::vector<record_t> m_Records{};	// Parallel to m_Classes.
+	inline std::size_t m_iDropped{};
+
+	// Cheap enough to call on every scope, but better kept in a static.
+	std::uint16_t ClassIndex(std::string_view szClass) noexcept
+	{
+		if (auto const it = std::ranges::find(m_Classes, szClass); it != m_Classes.end())
+			return (std::uint16_t)(it - m_Classes.begin());
+
+		m_Classes.emplace_back(szClass);
+		m_Records.emplace_back();
+
+		return (std::uint16_t)(m_Classes.size() - 1);
+	}
+
+	inline std::uint32_t Elapsed(std::chrono::steady_clock::time_point const& Start) noexcept
+	{
+		auto const iNanoSec = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+		return (std::uint32_t)std::clamp<std::int64_t>(iNanoSec, 0, std::numeric_limits<std::uint32_t>::max());
+	}
+
+	struct timed_scope_t
+	{
+		explicit timed_scope_t(EStage iStage, std::uint16_t iClass) noexcept
+			: m_Start{ std::chrono::steady_clock::now() }, m_iClass{ iClass }, m_iStage{ iStage } {}
+
+		~timed_scope_t() noexcept
+		{
+			m_Ring.Push({ .m_iNanoSec{ Elapsed(m_Start) }, .m_iClass{ m_iClass }, .m_iStage{ m_iStage } });
+		}
+
+		timed_scope_t(timed_scope_t const&) = delete;
+		timed_scope_t& operator=(timed_scope_t const&) = delete;
+
+		std::chrono::steady_clock::time_point m_Start;
+		std::uint16_t m_iClass;
+		EStage m_iStage;
+	};
+
+	// Opens the unit traces and messages are counted against. Nested shots count towards the inner one only.
+	struct timed_shot_t
+	{
+		explicit timed_shot_t(std::uint16_t iClass) noexcept
+			: m_Start{ std::chrono::steady_clock::now() }, m_iClass{ iClass },
+			m_bOuterInShot{ m_Ring.m_bInShot }, m_iOuterTraces{ m_Ring.m_iTraces }, m_iOuterMessages{ m_Ring.m_iMessages }
+		{
+			m_Ring.m_bInShot = true;
+			m_Ring.m_iTraces = 0;
+			m_Ring.m_iMessages = 0;
+		}
+
+		~timed_shot_t() noexcept
+		{
+			m_Ring.Push({
+				.m_iNanoSec{ Elapsed(m_Start) },
+				.m_iClass{ m_iClass },
+				.m_iStage{ STAGE_SHOT },
+				.m_iTraces{ (std::uint16_t)std::min<std::uint32_t>(m_Ring.m_iTraces, 0xFFFF) },
+				.m_iMessages{ (std::uint16_t)std::min<std::uint32_t>(m_Ring.m_iMessages, 0xFFFF) },
+			});
+
+			m_Ring.m_bInShot = m_bOuterInShot;
+			m_Ring.m_iTraces = m_iOuterTraces;
+			m_Ring.m_iMessages = m_iOuterMessages;
+		}
+
+		timed_shot_t(timed_shot_t const&) = delete;
+		timed_shot_t& operator=(timed_shot_t const&) = delete;
+
+		std::chrono::steady_clock::time_point m_Start;
+		std::uint16_t m_iClass;
+		bool m_bOuterInShot;
+		std::uint32_t m_iOuterTraces;
+		std::uint32_t m_iOuterMessages;
+	};
+
+	struct null_scope_t
+	{
+		explicit constexpr null_scope_t(EStage, std::uint16_t) noexcept {}
+	};
+
+	struct null_shot_t
+	{
+		explicit constexpr null_shot_t(std::uint16_t) noexcept {}
+	};
+
+	using scope_t = std::conditional_t<ENABLED, timed_scope_t, null_scope_t>;
+	using shot_t = std::conditional_t<ENABLED, timed_shot_t, null_shot_t>;
+
+	// Called from the engine hooks for the game dll and from the g_engfuncs wrappers for ourselves, see Plugin.cpp.
+	void OnTraceLine() noexcept
+	{
+		if (m_Ring.m_bInShot)
+			++m_Ring.m_iTraces;
+	}
+
+	void OnMessageBegin() noexcept
+	{
+		if (m_Ring.m_bInShot)
+			++m_Ring.m_iMessages;
+	}
+
+	// Move whatever this thread has buffered into the records. Once per frame is plenty.
+	void Flush() noexcept
+	{
+		for (auto&& Sample : std::span{ m_Ring.m_Samples }.first(m_Ring.m_iCount))
+		{
+			if (Sample.m_iClass >= m_Records.size())
+				continue;
+
+			auto& Record = m_Records[Sample.m_iClass];
+			Record.m_Stages[Sample.m_iStage].Add(Sample.m_iNanoSec);
+
+			if (Sample.m_iStage == STAGE_SHOT)
+			{
+				Record.m_Traces.Add(Sample.m_iTraces);
+				Record.m_Messages.Add(Sample.m_iMessages);
+			}
+		}
+
+		m_iDropped += m_Ring.m_iDropped;
+		m_Ring.m_iCount = 0;
+		m_Ring.m_iDropped = 0;
+	}
+
+	// One line per class and stage with samples, timings in microseconds.
+	std::string Report() noexcept
+	{
+		std::string ret = std::format("{:<20} {:<16} {:>8} {:>9} {:>9} {:>9} {:>9} {:>7} {:>7}\n",
+			"class", "stage", "count", "p50_us", "p99_us", "max_us", "mean_us", "traces", "msgs");
+
+		for (auto&& [szClass, Record] : std::views::zip(m_Classes, m_Records))
+		{
+			for (auto&& [iStage, Hist] : Record.m_Stages | std::views::enumerate)
+			{
+				if (!Hist.m_iCount)
+					continue;
+
+				auto const bShot = iStage == STAGE_SHOT;
+
+				ret += std::format("{:<20} {:<16} {:>8} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f} {:>7} {:>7}\n",
+					szClass, STAGE_NAMES[iStage], Hist.m_iCount,
+					Hist.Percentile(50) / 1e3, Hist.Percentile(99) / 1e3, Hist.m_iMax / 1e3, Hist.Mean() / 1e3,
+					bShot ? std::format("{:.1f}", Record.m_Traces.Mean()) : "",
+					bShot ? std::format("{:.1f}", Record.m_Messages.Mean()) : ""
+				);
+			}
+		}
+
+		if (m_iDropped)
+			ret += std::format("{} samples dropped, flush more often.\n", m_iDropped);
+
+		return ret;
+	}
+
+	void WriteCsv(std::FILE* f) noexcept
+	{
+		std::print(f, "class,stage,count,p50_ns,p99_ns,max_ns,mean_ns,traces_p50,traces_p99,msgs_p50,msgs_p99\n");
+
+		for (auto&& [szClass, Record] : std::views::zip(m_Classes, m_Records))
+		{
+			for (auto&& [iStage, Hist] : Record.m_Stages | std::views::enumerate)
+			{
+				if (!Hist.m_iCount)
+					continue;
+
+				auto const bShot = iStage == STAGE_SHOT;
+
+				std::print(f, "{},{},{},{},{},{},{:.0f},{},{},{},{}\n",
+					szClass, STAGE_NAMES[iStage], Hist.m_iCount,
+					Hist.Percentile(50), Hist.Percentile(99), Hist.m_iMax, Hist.Mean(),
+					bShot ? Record.m_Traces.Percentile(50) : 0, bShot ? Record.m_Traces.Percentile(99) : 0,
+					bShot ? Record.m_Messages.Percentile(50) : 0, bShot ? Record.m_Messages.Percentile(99) : 0
+				);
+			}
+		}
+	}
+
+	// Forget the numbers, keep the class indices since they sit in statics.
+	void Reset() noexcept
+	{
+		m_Ring.m_iCount = 0;
+		m_Ring.m_iDropped = 0;
+		m_iDropped = 0;
+
+		for (auto&& Record : m_Records)
+			Record = {};
+	}
+}
@@ -43,9 +43,9 @@ export [[nodiscard]] auto SvBlendingAPI() noexcept -> decltype(*gppSvBlendingAPI
 	return *gppSvBlendingAPI;
 }
 
-export [[nodiscard]] auto UTIL_GetAttachmentOffset(const char* pszModel, unsigned iAttachment, int iSequence = 0, float flFrame = 0) noexcept -> Vector
+// Runs the bones of the whole chain, don't call it directly.
+[[nodiscard]] auto StudioAttachmentOffset(int iModelIndex, unsigned iAttachment, int iSequence, float flFrame) noexcept -> Vector
 {
-	auto const iModelIndex = g_engfuncs.pfnModelIndex(pszModel);
 	auto const pstudiohdr = gpSvStudioAPI->Mod_Extradata(gpServerVars->models[iModelIndex]);
 
 	if (!pstudiohdr)
@@ -85,3 +85,127 @@ export [[nodiscard]] auto UTIL_GetAttachmentOffset(const char* pszModel, unsigne
 		(vec_t)DotProduct(pattachment->org, BoneTransform[2]) + BoneTransform[2][3],
 	};
 }
+
+export struct attachment_stats_t
+{
+	std::size_t m_iOffsetHits{};
+	std::size_t m_iOffsetMisses{};
+	std::size_t m_iOffsetBaked{};
+	std::size_t m_iEntityHits{};
+	std::size_t m_iEntityMisses{};
+};
+
+export inline attachment_stats_t gAttachmentStats{};
+
+// By model index, so any string naming the same model finds the same entry.
+using offset_key_t = std::tuple<int, unsigned, int, float>;
+
+// Offsets don't depend on any entity, they are good until the models are unloaded.
+inline std::map<offset_key_t, Vector> gAttachmentOffsets{};
+inline std::vector<std::tuple<const char*, unsigned, int, float>> gAttachmentOffsetsToBake{};
+
+struct entity_attachment_t
+{
+	short m_iEntity{};
+	short m_iModel{};
+	int m_iSequence{};
+	float m_flFrame{};
+	int m_iAttachment{};
+	std::array<float, 6> m_rgflPlacement{};	// origin and angles of the entity
+	Vector m_vecOrigin{};
+};
+
+// Whatever pfnGetAttachment returned this frame.
+inline std::vector<entity_attachment_t> gEntityAttachments{};
+inline float gEntityAttachmentsTime{ -1 };
+
+// Offset of the attachment from the model origin, on given keyframe. Intended for view models.
+export [[nodiscard]] auto UTIL_GetAttachmentOffset(const char* pszModel, unsigned iAttachment, int iSequence = 0, float flFrame = 0) noexcept -> Vector
+{
+	auto const iModelIndex = g_engfuncs.pfnModelIndex(pszModel);
+	auto const [it, bNew] = gAttachmentOffsets.try_emplace({ iModelIndex, iAttachment, iSequence, flFrame });
+
+	if (bNew)
+	{
+		it->second = StudioAttachmentOffset(iModelIndex, iAttachment, iSequence, flFrame);
+		++gAttachmentStats.m_iOffsetMisses;
+	}
+	else
+		++gAttachmentStats.m_iOffsetHits;
+
+	return it->second;
+}
+
+// Call on precache with the same arguments UTIL_GetAttachmentOffset() will get.
+// The bones are run once the engine studio API is available, so no shot pays for them.
+export void QueueAttachmentOffset(const char* pszModel, unsigned iAttachment, int iSequence, float flFrame) noexcept
+{
+	gAttachmentOffsetsToBake.emplace_back(pszModel, iAttachment, iSequence, flFrame);
+}
+
+// After RetrieveEngineStudio().
+export void BakeAttachmentOffsets() noexcept
+{
+	for (auto&& [pszModel, iAttachment, iSequence, flFrame] : gAttachmentOffsetsToBake)
+	{
+		auto const iModelIndex = g_engfuncs.pfnModelIndex(pszModel);
+		auto const [it, bNew] = gAttachmentOffsets.try_emplace({ iModelIndex, iAttachment, iSequence, flFrame });
+
+		if (!bNew)
+			continue;
+
+		it->second = StudioAttachmentOffset(iModelIndex, iAttachment, iSequence, flFrame);
+		++gAttachmentStats.m_iOffsetBaked;
+	}
+
+	gAttachmentOffsetsToBake.clear();
+}
+
+// pfnGetAttachment, but the bones are only set up once per frame for each entity, placement, pose and attachment.
+// An entity moved or turned within the same frame misses the cache instead of getting its old position.
+export [[nodiscard]] auto UTIL_GetEntityAttachment(edict_t* pEdict, int iAttachment) noexcept -> Vector
+{
+	if (gEntityAttachmentsTime != gpGlobals->time)
+	{
+		gEntityAttachmentsTime = gpGlobals->time;
+		gEntityAttachments.clear();
+	}
+
+	entity_attachment_t const Key{
+		.m_iEntity{ ent_cast<short>(pEdict) },
+		.m_iModel{ (short)pEdict->v.modelindex },
+		.m_iSequence{ pEdict->v.sequence },
+		.m_flFrame{ pEdict->v.frame },
+		.m_iAttachment{ iAttachment },
+		.m_rgflPlacement{
+			pEdict->v.origin[0], pEdict->v.origin[1], pEdict->v.origin[2],
+			pEdict->v.angles[0], pEdict->v.angles[1], pEdict->v.angles[2],
+		},
+	};
+
+	for (auto&& Cached : gEntityAttachments)
+	{
+		if (Cached.m_iEntity == Key.m_iEntity && Cached.m_iModel == Key.m_iModel && Cached.m_iSequence == Key.m_iSequence
+			&& Cached.m_flFrame == Key.m_flFrame && Cached.m_iAttachment == Key.m_iAttachment
+			&& Cached.m_rgflPlacement == Key.m_rgflPlacement)
+		{
+			++gAttachmentStats.m_iEntityHits;
+			return Cached.m_vecOrigin;
+		}
+	}
+
+	auto& Entry = gEntityAttachments.emplace_back(Key);
+	g_engfuncs.pfnGetAttachment(pEdict, iAttachment, Entry.m_vecOrigin, nullptr);
+
+	++gAttachmentStats.m_iEntityMisses;
+	return Entry.m_vecOrigin;
+}
+
+// Model indices and string pointers are reassigned on map change.
+export void ClearAttachmentCache() noexcept
+{
+	gAttachmentOffsets.clear();
+	gAttachmentOffsetsToBake.clear();
+	gEntityAttachments.clear();
+	gEntityAttachmentsTime = -1;
+}
@@ -0,0 +1,168 @@
+export module TextureCache;
+
+import std;
+import hlsdk;
+
+import CBase;
+import FileSystem;
+import Uranus;
+
+
+
+export namespace TextureCache
+{
+	// Same file the game reads its CHAR_TEX_* table from.
+	inline constexpr char TEXTURE_TYPES_FILE[] = "sound/materials.txt";
+
+	// CBTEXTURENAMEMAX - 1, the game only ever compares this many characters of a texture name.
+	inline constexpr std::size_t TEXTURE_NAME_LEN = 12;
+
+	// CTEXTURESMAX, the game stops reading after this many entries, duplicates included.
+	inline constexpr std::size_t TEXTURE_TYPES_MAX = 512;
+
+	struct stats_t
+	{
+		std::size_t m_iLookups{};
+		std::size_t m_iHits{};
+		std::size_t m_iMisses{};	// texture never seen on this map, resolved by name
+		std::size_t m_iFlesh{};	// living entity, no texture involved
+		std::size_t m_iUntextured{};
+		std::size_t m_iTypes{};	// entries read from TEXTURE_TYPES_FILE, duplicates included
+	};
+
+	inline stats_t m_Stats{};
+
+	// Lower case and truncated texture name -> CHAR_TEX_*
+	inline std::unordered_map<std::string, char> m_Types{};
+
+	// Texture names handed out by the engine point into the loaded models, they stay put until the map changes.
+	inline std::unordered_map<char const*, char> m_Surfaces{};
+}
+
+// Drop the prefixes of animated, random tiling, transparent, water and lights textures, as UTIL_TextureHit() does.
+[[nodiscard]] inline std::string NormalizeName(std::string_view sz) noexcept
+{
+	if (sz.size() >= 2 && (sz[0] == '-' || sz[0] == '+'))
+		sz.remove_prefix(2);
+
+	if (!sz.empty() && (sz[0] == '{' || sz[0] == '!' || sz[0] == '~' || sz[0] == ' '))
+		sz.remove_prefix(1);
+
+	std::string ret{ sz.substr(0, TextureCache::TEXTURE_NAME_LEN) };
+
+	for (auto&& c : ret)
+		c = (char)std::tolower((unsigned char)c);
+
+	return ret;
+}
+
+export namespace TextureCache
+{
+	// Same rules as TEXTURETYPE_Init(), line length and entry limit included. The first entry of a name wins like the linear search it replaces.
+	void Parse(std::FILE* f) noexcept
+	{
+		// memfgets() is handed sizeof(buffer) - 1, so at most 510 characters of a line are read at once.
+		char szLine[512]{};
+		std::size_t iEntries{};
+
+		while (iEntries < TEXTURE_TYPES_MAX && std::fgets(szLine, sizeof(szLine) - 1, f))
+		{
+			std::size_t i = 0;
+			while (szLine[i] && std::isspace((unsigned char)szLine[i]))
+				++i;
+
+			// Comments and anything which is not led by a type character.
+			if (!szLine[i] || !std::isalpha((unsigned char)szLine[i]))
+				continue;
+
+			auto const cType = (char)std::toupper((unsigned char)szLine[i++]);
+
+			while (szLine[i] && std::isspace((unsigned char)szLine[i]))
+				++i;
+
+			auto j = i;
+			while (szLine[j] && !std::isspace((unsigned char)szLine[j]))
+				++j;
+
+			// The name must be followed by whitespace, so a last line without line break is dropped. Also covers the empty name.
+			if (!szLine[j])
+				continue;
+
+			std::string szKey{ &szLine[i], std::min(j - i, TEXTURE_NAME_LEN) };
+			for (auto&& c : szKey)
+				c = (char)std::tolower((unsigned char)c);
+
+			m_Types.try_emplace(std::move(szKey), cType);
+			++iEntries;
+		}
+
+		m_Stats.m_iTypes = iEntries;
+	}
+
+	// Parse the texture type table once.
+	void Load() noexcept
+	{
+		if (!m_Types.empty())
+			return;
+
+		// Binary, as the game reads the whole file into memory first.
+		auto const f = FileSystem::FOpen(TEXTURE_TYPES_FILE, "rb");
+		if (!f)
+			return;
+
+		Parse(f);
+		std::fclose(f);
+	}
+
+	// CHAR_TEX_* of a texture name, CHAR_TEX_CONCRETE if it is not in the table like TEXTURETYPE_Find().
+	[[nodiscard]] char Find(std::string_view szTexture) noexcept
+	{
+		if (auto const it = m_Types.find(NormalizeName(szTexture)); it != m_Types.end())
+			return it->second;
+
+		return CHAR_TEX_CONCRETE;
+	}
+
+	// Drop-in for UTIL_TextureHit(). The engine still traces for the texture, but each texture is only looked up once per map.
+	[[nodiscard]] char Hit(TraceResult const* ptr, Vector const& vecSrc, Vector const& vecEnd) noexcept
+	{
+		// Table missing, let the game have its say.
+		if (m_Types.empty()) [[unlikely]]
+			return Uranus::UTIL_TextureHit{}(const_cast<TraceResult*>(ptr), vecSrc, vecEnd);
+
+		++m_Stats.m_iLookups;
+
+		auto const pHit = ptr->pHit ? ptr->pHit : ent_cast<edict_t*>(0);
+
+		if (auto const pEntity = ent_cast<CBaseEntity*>(pHit); pEntity)
+		{
+			if (auto const iClass = pEntity->Classify(); iClass != CLASS_NONE && iClass != CLASS_MACHINE)
+			{
+				++m_Stats.m_iFlesh;
+				return CHAR_TEX_FLESH;
+			}
+		}
+
+		auto const pszTexture = g_engfuncs.pfnTraceTexture(pHit, vecSrc, vecEnd);
+		if (!pszTexture)
+		{
+			++m_Stats.m_iUntextured;
+			return 0;
+		}
+
+		if (auto const it = m_Surfaces.find(pszTexture); it != m_Surfaces.end())
+		{
+			++m_Stats.m_iHits;
+			return it->second;
+		}
+
+		++m_Stats.m_iMisses;
+		return m_Surfaces.try_emplace(pszTexture, Find(pszTexture)).first->second;
+	}
+
+	// The texture names are gone with the models of the map. The type table stays.
+	void Clear() noexcept
+	{
+		m_Surfaces.clear();
+	}
+}